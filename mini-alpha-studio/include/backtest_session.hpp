@@ -0,0 +1,48 @@
+#pragma once
+#include "indicator_cache.hpp"
+#include "strategy.hpp"
+#include <cstddef>
+
+// One series backtested over and over as its params are edited (GUI
+// sliders). update() redoes only what the edit invalidated:
+//  - fast/slow: the SMAs come from a per-window memo (each window length is
+//    computed once), then the crossover is scanned and the bars marked;
+//  - fee/slippage only: the scanned trade bars are kept and only the PnL
+//    pass runs over them.
+// Results are bit-identical to run_ma_crossover(series, params).
+//
+// Not thread-safe; meant to be owned by the thread that draws the result.
+class BacktestSession {
+public:
+    explicit BacktestSession(SeriesPtr series);
+
+    // The result for p, recomputed only if p differs from the last call.
+    // The reference stays valid until the next update().
+    const BacktestResult& update(const MAParams& p);
+
+    const BacktestResult& result() const { return ws_.result; }
+    const MAParams&       params() const { return p_; }
+    const BarSeries&      series() const { return sma_.series(); }
+
+    // Bumped whenever update() changes the result: version() on any change,
+    // signal_version() only when trades or the curve's prices may have
+    // changed (not on cost-only edits). For caches derived from the result.
+    size_t version()        const { return version_; }
+    size_t signal_version() const { return signal_version_; }
+
+    size_t signal_runs() const { return signal_runs_; }   // SMA lookups + scans
+    size_t pnl_runs()    const { return pnl_runs_; }      // PnL passes (every recompute)
+    double last_ms()     const { return last_ms_; }       // time of the last recompute
+
+private:
+    SmaCache          sma_;
+    BacktestWorkspace ws_;       // result, plus SMA scratch past the memo's budget
+    CrossoverSignal   sig_;
+    MAParams          p_;
+    const double*     fast_ma_ = nullptr;
+    const double*     slow_ma_ = nullptr;
+    bool              scanned_ = false;
+    size_t            version_ = 0, signal_version_ = 0;
+    size_t            signal_runs_ = 0, pnl_runs_ = 0;
+    double            last_ms_ = 0.0;
+};
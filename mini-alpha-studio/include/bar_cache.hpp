@@ -0,0 +1,44 @@
+#pragma once
+#include "bar_series.hpp"
+#include <cstdint>
+#include <string>
+
+// Binary columnar cache of a parsed CSV, stored next to it as "<csv>.bars".
+//
+// Layout (little-endian):
+//   BarCacheHeader                         64 bytes
+//   warn text, zero-padded to 8 bytes      header.warn_len
+//   ts_ms[count]                           int64
+//   open[count] high[count] low[count] close[count] volume[count]   double
+//
+// The header records the source CSV's size and mtime plus a checksum of both;
+// a cache whose stamp doesn't match the CSV on disk is treated as stale.
+
+constexpr uint32_t kBarCacheVersion = 1;
+
+struct BarCacheHeader {
+    char     magic[8];      // "MABARS\0\0"
+    uint32_t version;       // kBarCacheVersion
+    uint32_t columns;       // 6
+    uint64_t count;         // bars per column
+    uint64_t src_size;      // CSV size in bytes
+    int64_t  src_mtime;     // CSV last_write_time ticks
+    uint64_t src_check;     // checksum of (version, src_size, src_mtime)
+    uint32_t warn_len;      // loader warning carried over from the text parse
+    uint32_t reserved0;
+    uint64_t reserved1;
+};
+static_assert(sizeof(BarCacheHeader) == 64, "cache header must stay 64 bytes");
+
+std::string bar_cache_path(const std::string& csv_path);
+
+// Fills out/warn from the cache if it is present and fresh. The file is read
+// via mmap and each column copied into out, which owns its memory once this
+// returns. Returns false on a missing, stale or corrupt cache; out is left
+// empty in that case.
+bool read_bar_cache(const std::string& csv_path, BarSeries& out, std::string& warn);
+
+// Best-effort: writes atomically (temp file + rename) and returns false on any
+// I/O error, e.g. a read-only data directory.
+bool write_bar_cache(const std::string& csv_path, const BarSeries& bars,
+                     const std::string& warn);
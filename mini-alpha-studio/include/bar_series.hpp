@@ -0,0 +1,62 @@
+#pragma once
+#include "model.hpp"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Allocator that starts every block on a cache-line boundary, so columns can
+// be streamed with aligned vector loads.
+template <class T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+
+    template <class U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Struct-of-arrays bar series: one contiguous, 64-byte aligned column per
+// field. Hot loops read only the columns they need (usually close + ts_ms);
+// operator[] rebuilds a Bar for code that still wants records.
+struct BarSeries {
+    AlignedVector<int64_t> ts_ms;
+    AlignedVector<double>  open, high, low, close, volume;
+
+    size_t size()  const { return ts_ms.size(); }
+    bool   empty() const { return ts_ms.empty(); }
+    size_t bytes() const { return size() * (sizeof(int64_t) + 5 * sizeof(double)); }
+
+    Bar operator[](size_t i) const {
+        return Bar{ts_ms[i], open[i], high[i], low[i], close[i], volume[i]};
+    }
+
+    void push_back(const Bar& b) {
+        ts_ms.push_back(b.ts_ms); open.push_back(b.open); high.push_back(b.high);
+        low.push_back(b.low); close.push_back(b.close); volume.push_back(b.volume);
+    }
+
+    void reserve(size_t n);
+    void resize(size_t n);
+    void clear();
+    void append(const BarSeries& o);
+    void reverse();
+
+    // Adapters for the record-based API
+    static BarSeries from_bars(const std::vector<Bar>& bars);
+    std::vector<Bar> to_bars() const;
+};
+
+// Immutable, shareable series (see DatasetRegistry).
+using SeriesPtr = std::shared_ptr<const BarSeries>;
@@ -0,0 +1,67 @@
+#pragma once
+#include "csv_row.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Pull-based reader over a bar CSV with a fixed-size read buffer, so memory
+// use is independent of file length. Accepts the same schemas and yields the
+// same bars in the same order as load_bar_series; warnings use the same
+// wording and line numbers.
+//
+// Newest-first vendor files are detected the way the loader does (first vs.
+// last valid row) and read backwards block by block instead of being reversed
+// in memory.
+//
+//   BarStream in;
+//   if (!in.open(path, err)) ...
+//   Bar b;
+//   while (in.next(b)) { ... }
+class BarStream {
+public:
+    explicit BarStream(size_t buffer_bytes = size_t(256) << 10);
+    ~BarStream();
+    BarStream(const BarStream&) = delete;
+    BarStream& operator=(const BarStream&) = delete;
+
+    bool open(const std::string& path, std::string& err);
+    void close();
+
+    // Next bar in ascending time order; false at end of data.
+    bool next(Bar& b);
+
+    // Last non-fatal issue so far, same wording as load_csv's warn.
+    const std::string& warn() const { return warn_; }
+    size_t count()    const { return count_; }      // bars returned so far
+    bool   reversed() const { return reverse_; }    // file is newest-first
+
+private:
+    bool next_line(const char*& lb, const char*& le);
+    bool fwd_line(const char*& lb, const char*& le);
+    bool rev_line(const char*& lb, const char*& le);
+    void rewind_forward();
+    void rewind_reverse();
+
+    std::FILE*        f_ = nullptr;
+    std::vector<char> buf_;
+    CsvSchema         schema_ = CsvSchema::Unknown;
+    bool              reverse_ = false;
+    int64_t           data_begin_ = 0;   // file offset after the header
+    int64_t           data_end_ = 0;     // file offset of the end of data
+    bool              ends_nl_ = false;  // data ends with '\n' (no empty last line)
+
+    // Forward mode: unread bytes are buf_[lo_, hi_); file_pos_ is the next read.
+    // Reverse mode: unread tail is buf_[lo_, hi_); file_pos_ is the offset
+    // just past the bytes still to be read (reading proceeds towards data_begin_).
+    size_t            lo_ = 0, hi_ = 0;
+    int64_t           file_pos_ = 0;
+    bool              eof_ = false;
+    bool              skip_ = false;     // dropping the rest of an over-long line
+
+    size_t            line_ = 1;         // line number of the last line returned
+    size_t            total_lines_ = 0;  // data lines, needed to number lines in reverse
+    int64_t           last_ts_ = -1;
+    size_t            count_ = 0;
+    std::string       warn_;
+};
@@ -1,9 +1,36 @@
 #pragma once
-#include "model.hpp"
+#include "bar_series.hpp"
 #include <string>
 #include <vector>
 
+// Timing of one load_csv call. bytes is the size of whatever was read: the CSV
+// text, or the .bars cache when from_cache is set.
+struct CsvLoadStats {
+    size_t   bytes = 0;
+    double   seconds = 0.0;
+    unsigned threads = 1;     // parser threads used for the text path
+    bool     from_cache = false;
+    double mb_per_s() const { return seconds > 0 ? bytes / 1e6 / seconds : 0.0; }
+};
+
 // Load CSV of format: ts_ms,open,high,low,close,volume
+// or vendor format:    Date,Close/Last,Volume,Open,High,Low  (MM/DD/YYYY, $-prefixed)
+// The file is memory-mapped and parsed in place. err is set on failure; warn
+// holds the last non-fatal issue (skipped or out-of-order line).
+//
+// A successful parse is cached next to the CSV as "<csv>.bars" (see
+// bar_cache.hpp) and later loads map that instead while it is fresh. Set
+// MINI_ALPHA_BAR_CACHE=0 to always parse the text.
+//
+// Files larger than a few MB are split into newline-aligned chunks parsed on
+// one thread per core; results, warnings and ordering match a single pass.
+BarSeries load_bar_series(const std::string& path,
+                          std::string& warn,
+                          std::string& err,
+                          CsvLoadStats* stats = nullptr);
+
+// Record-based adapter over load_bar_series.
 std::vector<Bar> load_csv(const std::string& path,
                           std::string& warn,
-                          std::string& err);
+                          std::string& err,
+                          CsvLoadStats* stats = nullptr);
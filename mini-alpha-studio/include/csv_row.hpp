@@ -0,0 +1,15 @@
+#pragma once
+#include "model.hpp"
+#include <string>
+
+// Row-level pieces of the CSV loader, shared by load_bar_series and BarStream.
+
+enum class CsvSchema { Unknown, TsMs, DateCloseLast };
+
+// Detects the schema from the header line (case- and space-insensitive).
+CsvSchema detect_csv_schema(const std::string& header);
+
+// Parses one line [lb, le), without its newline. Returns nullptr on success,
+// otherwise the loader's warning prefix ("Malformed line ", ...) to which the
+// caller appends the line number.
+const char* parse_csv_row(const char* lb, const char* le, CsvSchema schema, Bar& b);
@@ -0,0 +1,63 @@
+#pragma once
+#include "csv.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <future>
+#include <vector>
+
+// One loaded file as handed out by the registry.
+struct Dataset {
+    std::string  path;            // as requested
+    SeriesPtr    series;          // null when err is set
+    std::string  warn, err;
+    CsvLoadStats stats;           // from the load that produced this series
+};
+
+// Process-wide load-once cache of bar series, keyed by canonical path, size
+// and mtime, so a file edited on disk is reloaded. Series are immutable and
+// shared; eviction (LRU, by memory budget) only drops the registry's
+// reference, never a series someone still holds. Failed loads aren't cached.
+class DatasetRegistry {
+public:
+    explicit DatasetRegistry(size_t budget_bytes = size_t(1) << 30);
+
+    static DatasetRegistry& instance();
+
+    // Cached series or a fresh load on the calling thread. Concurrent callers
+    // asking for the same file share one load.
+    Dataset get(const std::string& path);
+
+    // Same, for several files; misses are loaded concurrently on the shared
+    // thread pool, the calling thread included, so it is safe to call from a
+    // pool job. Results are in input order.
+    std::vector<Dataset> get_many(const std::vector<std::string>& paths);
+
+    void   set_budget(size_t bytes);
+    size_t budget() const;
+    size_t bytes_in_use() const;
+    size_t hits() const;
+    size_t misses() const;
+    void   clear();
+
+private:
+    struct Entry {
+        std::string canonical;
+        Dataset     data;
+        size_t      bytes = 0;
+        std::list<std::string>::iterator lru;   // position in lru_ (front = newest)
+    };
+
+    void insert_locked(const std::string& key, Entry e);
+    void evict_locked();
+
+    mutable std::mutex mu_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<std::string, std::shared_future<Dataset>> inflight_;
+    std::list<std::string> lru_;
+    size_t budget_ = 0, used_ = 0;
+    size_t hits_ = 0, misses_ = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "bar_series.hpp"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Per-dataset memo of SMA columns for one search. Each distinct window is
+// computed once with compute_sma(), so cached values are bit-identical to what
+// run_ma_crossover computes itself and searches pick the same winners.
+// (A prefix-sum table would answer any window in O(1) but rounds differently
+// from the rolling sum and can flip near-tied crossovers.)
+//
+// Thread-safe: concurrent get() calls for the same window compute it once.
+class SmaCache {
+public:
+    // budget_bytes caps the memoized columns; windows that don't fit are
+    // computed into the caller's scratch buffer instead.
+    explicit SmaCache(SeriesPtr series, size_t budget_bytes = size_t(512) << 20);
+
+    const BarSeries& series() const { return *series_; }
+    const SeriesPtr& series_ptr() const { return series_; }
+
+    // SMA column for window w (size() == series().size(), NAN during warm-up).
+    // The pointer stays valid for the cache's lifetime, or until the next use
+    // of scratch when the window wasn't cacheable.
+    const double* get(int w, std::vector<double>& scratch);
+
+    size_t windows_cached() const;
+    size_t bytes() const;
+
+private:
+    struct Slot {
+        std::once_flag      once;
+        std::vector<double> values;
+    };
+
+    SeriesPtr series_;
+    size_t    budget_;
+    mutable std::mutex mu_;
+    std::unordered_map<int, std::unique_ptr<Slot>> slots_;
+    size_t    used_ = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Latest-value mailbox between one producer and one consumer (a triple
+// buffer). post() and take() never block or allocate beyond T's own moves:
+// the producer fills its private slot and swaps it into the middle, the
+// consumer swaps the middle out when it is marked fresh. Values the consumer
+// didn't get to in time are overwritten, which is what a render loop wants.
+//
+// Several producers are fine as long as their post() calls are serialized
+// (e.g. by a mutex on the producing side); the consumer side stays lock-free.
+template <class T>
+class Mailbox {
+public:
+    void post(T v) {
+        slots_[back_] = std::move(v);
+        const uint8_t prev = mid_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel);
+        back_ = prev & kIndex;
+    }
+
+    // Moves the newest value not yet taken into out; false if there is none.
+    bool take(T& out) {
+        if (!(mid_.load(std::memory_order_acquire) & kFresh)) return false;
+        const uint8_t prev = mid_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & kIndex;
+        out = std::move(slots_[front_]);
+        return true;
+    }
+
+private:
+    static constexpr uint8_t kIndex = 3, kFresh = 4;
+
+    T                    slots_[3];
+    std::atomic<uint8_t> mid_{1};
+    uint8_t              back_  = 0;   // producer's slot
+    uint8_t              front_ = 2;   // consumer's slot
+};
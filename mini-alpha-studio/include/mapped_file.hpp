@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Uses mmap on POSIX; on other platforms the
+// file is read into an owned buffer so callers can still walk bytes in place.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+    // Returns false and fills err on failure. An empty file maps successfully
+    // with size() == 0.
+    bool open(const std::string& path, std::string& err);
+    void close();
+
+    const char* data() const { return data_; }
+    size_t      size() const { return size_; }
+    bool        is_open() const { return open_; }
+
+private:
+    const char*       data_ = nullptr;
+    size_t            size_ = 0;
+    bool              open_ = false;
+    bool              mapped_ = false;   // true when data_ came from mmap
+    std::vector<char> buf_;              // fallback storage
+};
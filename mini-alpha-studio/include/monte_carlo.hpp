@@ -0,0 +1,66 @@
+#pragma once
+#include "optimize.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Monte Carlo robustness checks of one backtest. Three kinds of resampled
+// scenarios are run from the result's curve and trades, never by re-running
+// the backtest:
+//  - bootstrap: the per-bar equity changes, resampled in circular blocks
+//    (keeping short-range autocorrelation) into a path of the same length;
+//  - shuffle:   the round-trip trade PnLs in random order. The total is the
+//    same in every shuffle; what varies is the drawdown, measured trade to
+//    trade;
+//  - costs:     fee_bps and slippage_bps each moved by a uniform draw in
+//    [-jitter, +jitter] (the total floored at 0). Costs are linear in the
+//    traded notional, so the curve is adjusted, not recomputed.
+//
+// Scenario s of a kind draws from its own counter-based stream keyed by
+// (seed, kind, s), so results don't depend on the thread count or on how
+// scenarios are split between threads.
+struct RobustnessSpec {
+    size_t   scenarios  = 10000;   // per kind
+    size_t   block_bars = 20;      // bootstrap block length
+    double   fee_jitter_bps      = 2.0;
+    double   slippage_jitter_bps = 2.0;
+    uint64_t seed       = 1;
+    bool     bootstrap  = true;
+    bool     shuffle    = true;
+    bool     costs      = true;
+};
+
+struct RobustnessOptions {
+    unsigned                 threads  = 0;         // as in OptOptions
+    OptProgress*             progress = nullptr;   // done/total count scenarios; best unused
+    const std::atomic<bool>* cancel   = nullptr;
+};
+
+// One kind's outcomes, each sorted ascending (scenario order is not kept).
+struct ScenarioDist {
+    std::vector<double> pnl, max_dd;
+    double pnl_mean = 0.0, pnl_std = 0.0;
+    double dd_mean  = 0.0, dd_std  = 0.0;
+    double loss_rate = 0.0;   // share of scenarios with pnl < 0
+
+    bool   empty() const { return pnl.empty(); }
+    // Nearest-rank quantiles, q in [0, 1]; NaN when empty.
+    double pnl_quantile(double q) const;
+    double dd_quantile(double q) const;
+};
+
+struct RobustnessResult {
+    double base_pnl = 0.0, base_max_dd = 0.0;   // the analysed backtest
+    size_t trips = 0;                           // round trips (the last may be open)
+    ScenarioDist bootstrap, shuffle, costs;     // empty when disabled or cancelled
+    bool   cancelled = false;
+};
+
+// Scenarios around r, a run_ma_crossover result with params p (whose costs
+// the cost scenarios perturb).
+RobustnessResult robustness_analysis(const BacktestResult& r, const MAParams& p,
+                                     const RobustnessSpec& spec, const RobustnessOptions& opt = {});
+
+// Same, running p on bars first.
+RobustnessResult robustness_analysis(const BarSeries& bars, const MAParams& p,
+                                     const RobustnessSpec& spec, const RobustnessOptions& opt = {});
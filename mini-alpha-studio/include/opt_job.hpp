@@ -0,0 +1,64 @@
+#pragma once
+#include "optimize.hpp"
+#include "result_store.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What to search, plus an optional series to re-run the winner on so the
+// caller gets its curve without doing any work itself.
+struct OptJobRequest {
+    std::vector<std::string> paths;
+    MAParams  base;
+    int       fast_min = 5, fast_max = 60;
+    int       slow_min = 20, slow_max = 200;
+    SearchStrategy strategy = SearchStrategy::Grid;
+    std::string store_path;          // optional ResultStore file shared across searches
+    SeriesPtr replay;
+};
+
+struct OptJobResult {
+    OptResult      opt;
+    BacktestResult run;              // winner on request.replay (empty without one)
+    double         seconds = 0.0;
+};
+
+// grid_search_fast_slow on a background thread, for a render loop that must
+// not stall. The loop polls progress()/eta_s() and take_best() for a live
+// best-so-far, and take_result() for the final answer; none of these block.
+// notify, if given, is called from the job's threads whenever there is
+// something new to poll (progress, a better pair, the result), so a loop
+// that sleeps until its next event can be woken instead of spinning.
+class OptimizeJob {
+public:
+    explicit OptimizeJob(std::function<void()> notify = {});
+    ~OptimizeJob() { stop(); }
+    OptimizeJob(const OptimizeJob&) = delete;
+    OptimizeJob& operator=(const OptimizeJob&) = delete;
+
+    // False if a search is still running.
+    bool start(OptJobRequest req);
+    void cancel() { cancel_ = true; }
+    void stop();                          // cancels a running search and joins it
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+    const OptProgress& progress() const { return progress_; }
+    double elapsed_s() const;
+    double eta_s() const;                 // < 0 while unknown
+
+    bool take_best(OptResult& out) { return progress_.best.take(out); }
+    bool take_result(OptJobResult& out) { return result_.take(out); }
+
+private:
+    std::thread                           thread_;
+    std::atomic<bool>                     cancel_{false};
+    std::atomic<bool>                     running_{false};
+    std::chrono::steady_clock::time_point t0_{};
+    std::function<void()>                 notify_;
+    OptProgress                           progress_;
+    ResultStore                           store_;     // only touched by the search thread
+    Mailbox<OptJobResult>                 result_;
+};
@@ -1,15 +1,156 @@
 #pragma once
+#include "mailbox.hpp"
 #include "strategy.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+// One dataset's part of a candidate's score.
+struct DatasetScore {
+    double score  = 0.0;
+    double pnl    = 0.0;
+    double max_dd = 0.0;
+    size_t trades = 0;
+};
+
+// A (fast, slow) pair scored on all the data. pnl, max_dd and trades are
+// averages over the datasets, like score.
+struct OptCandidate {
+    int    fast = 0, slow = 0;
+    double score  = -1e300;
+    double pnl    = 0.0;
+    double max_dd = 0.0;
+    double trades = 0.0;
+    std::vector<DatasetScore> datasets;   // search order; empty datasets skipped
+};
+
+// Average score of every pair in the searched ranges, as floats, row-major by
+// fast. NaN where there is no full-data score: slow <= fast, pairs a sampling
+// strategy never reached, or a cancelled search.
+struct ScoreSurface {
+    int fast_min = 0, fast_max = -1;
+    int slow_min = 0, slow_max = -1;
+    std::vector<float> score;
+
+    int rows() const { return fast_max - fast_min + 1; }   // one per fast
+    int cols() const { return slow_max - slow_min + 1; }   // one per slow
+    float at(int fast, int slow) const {
+        if (fast < fast_min || fast > fast_max || slow < slow_min || slow > slow_max) return NAN;
+        return score[size_t(fast - fast_min) * size_t(cols()) + size_t(slow - slow_min)];
+    }
+};
+
 struct OptResult {
     int best_fast = 0;
     int best_slow = 0;
     double best_score = -1e300;  // higher is better
+    bool cancelled = false;      // stopped early; best of the pairs scored so far
+    size_t evaluations = 0;      // backtests run ((fast, slow) pair x dataset or slice)
+    size_t bars_evaluated = 0;   // bars those backtests covered
+    size_t store_hits = 0;       // backtests read back from OptOptions::store instead
+    unsigned crashed_workers = 0;   // worker processes that died or hit the task timeout (work redone)
+    std::vector<OptCandidate> top;   // best first, up to OptOptions::top_k; top[0] is best_*
+    ScoreSurface surface;            // empty in live progress updates
 };
 
+// How grid_search_fast_slow explores the (fast, slow) grid. Grid scores every
+// pair; the others score a fraction of it (far fewer backtests on large grids
+// and universes) and return the best pair they scored on all the data.
+enum class SearchStrategy {
+    Grid,                // exhaustive
+    CoarseToFine,        // coarse lattice, then refine around the top-K cells
+    SuccessiveHalving,   // all pairs on a recent slice, keep the better half, double the data
+    Random,              // seeded uniform sample
+};
+const char* search_strategy_name(SearchStrategy s);
+
+class ResultStore;
+class SmaCache;
+
+// Live view of a running search, written by the search and read from any
+// thread (typically a render loop) without blocking it.
+struct OptProgress {
+    std::atomic<size_t> done{0};     // (fast, slow) pairs scored on every dataset
+    std::atomic<size_t> total{0};    // pairs in the grid
+    Mailbox<OptResult>  best;        // posted whenever the best so far improves
+    // Optional; called from search threads after done or best moves, so a
+    // reader that sleeps between polls can be woken. Must be cheap and
+    // thread-safe (e.g. set a flag and post one event).
+    std::function<void()> notify;
+};
+
+// Search knobs. With the Grid strategy the result never depends on the
+// thread count, nor (for a given seed) with the others.
+struct OptOptions {
+    // 0 = the shared ThreadPool (one worker per hardware thread) plus the
+    // caller; 1 = the calling thread only; n > 1 = n threads in total.
+    unsigned threads = 0;
+    // > 1: backtests run in this many forked worker processes (POSIX; falls
+    // back to threads elsewhere). The threads then only do store lookups,
+    // scoring and any work a crashed worker left.
+    unsigned processes = 0;
+    // A worker process still on one task after this long is killed and the
+    // task is run in-process instead; 0 = wait for it indefinitely.
+    unsigned process_task_timeout_ms = 30000;
+    OptProgress*             progress = nullptr;   // optional
+    const std::atomic<bool>* cancel   = nullptr;   // optional; set to stop early
+
+    SearchStrategy strategy    = SearchStrategy::Grid;
+    int            coarse_step = 0;    // CoarseToFine lattice spacing; 0 = range / 16
+    size_t         refine_k    = 4;    // CoarseToFine cells refined per round
+    size_t         samples     = 0;    // Random sample size; 0 = grid / 32 (at least 64)
+    uint64_t       seed        = 1;    // Random
+
+    size_t top_k = 10;   // candidates returned in OptResult::top, with breakdowns
+
+    // Optional memo of whole-dataset results: pairs found there are not run
+    // again, new results are appended to it when the search ends.
+    ResultStore* store = nullptr;
+
+    // Only bars [bar_begin, bar_end) of each dataset are scored (clamped to
+    // its size; datasets left empty are skipped), with the MAs warmed up on
+    // the bars before bar_begin. The store is only used for whole datasets.
+    size_t bar_begin = 0;
+    size_t bar_end   = SIZE_MAX;
+};
+
+// The score every search maximizes for one dataset: pnl lightly penalized by
+// drawdown. Searches average it over their datasets.
+double score_run(const BacktestStats& s);
+
+// Searches the fast < slow pairs in the ranges with opt.strategy and returns
+// the best average score over all datasets. Ties go to the first pair in
+// (fast, slow) order.
 OptResult grid_search_fast_slow(const std::vector<std::string>& csv_paths,
                                 const MAParams& base,   // use base.fee_bps & slippage
                                 int fast_min, int fast_max,
-                                int slow_min, int slow_max);
+                                int slow_min, int slow_max,
+                                const OptOptions& opt = {});
+
+// Same search over already-loaded series (null/empty series are skipped).
+// The path-based overload resolves files through DatasetRegistry, so repeated
+// searches over the same files don't touch the disk again.
+OptResult grid_search_fast_slow(const std::vector<SeriesPtr>& datasets,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt = {});
+
+OptResult grid_search_fast_slow(const std::vector<BarSeries>& datasets,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt = {});
+
+// Same search with caller-owned SMA memos, one per dataset. Searches that
+// share them (walk-forward folds over one series, say) compute each window once.
+OptResult grid_search_fast_slow(const std::vector<std::shared_ptr<SmaCache>>& smas,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt = {});
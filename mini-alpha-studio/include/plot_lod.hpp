@@ -0,0 +1,107 @@
+#pragma once
+#include "strategy.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Level-of-detail pyramid over one plotted column (price or equity), built
+// once per result so each frame draws O(pixel width) primitives however many
+// points there are. It holds:
+//  - min/max of every block of 8, 16, 32, ... points, so the extremes of any
+//    index range come back in O(log n) and no spike is lost to decimation;
+//  - Largest-Triangle-Three-Buckets selections of 2^k points (at most
+//    kMaxTrace, down to kMinTrace), each decimated from the one above it,
+//    which keep the trace's visual shape with about one point per pixel.
+// A zoomed view asks for its visible range only, so a frame's work follows
+// the pixel width and the visible range, not the series length.
+// Values are stored as floats: they only ever become pixel coordinates.
+class SeriesLod {
+public:
+    static constexpr size_t kMaxTrace = 16384;
+    static constexpr size_t kMinTrace = 256;
+
+    // field is read from each element of the array, e.g. &BacktestPoint::px.
+    template <class T>
+    void build(const std::vector<T>& items, double T::* field) {
+        std::vector<float> y(items.size());
+        for (size_t i = 0; i < items.size(); ++i) y[i] = static_cast<float>(items[i].*field);
+        build(std::move(y));
+    }
+    void build(std::vector<float> y);
+    void clear();
+
+    size_t size() const { return y_.size(); }
+    bool   empty() const { return y_.empty(); }
+    float  value(size_t i) const { return y_[i]; }
+
+    // Min and max over [begin, end) (begin < end <= size()), in O(log n).
+    std::pair<float, float> minmax(size_t begin, size_t end) const;
+
+    // The smallest stored LTTB selection with at least `points` points, as
+    // ascending indices; every index when there are no more points than
+    // that. Always keeps the first and last point.
+    const std::vector<uint32_t>& trace(size_t points) const;
+
+    // Indices to draw [begin, end) with about `points` points, into out:
+    // every index when the range holds no more than 2 * points; else the
+    // stored trace dense enough for the range, cut to it by binary search,
+    // or (zoomed in past the densest trace) an LTTB pass over the range
+    // itself. One index beyond each end is included where there is one, so
+    // the line runs to the plot's edges.
+    void trace(size_t begin, size_t end, size_t points, std::vector<uint32_t>& out) const;
+
+private:
+    static constexpr unsigned kLeafShift = 3;   // level 0 blocks are 8 points
+
+    std::vector<float> y_;
+    std::vector<std::vector<std::pair<float, float>>> levels_;   // [k]: blocks of 8 << k
+    std::vector<std::vector<uint32_t>> traces_;                  // largest first
+    std::vector<uint32_t> all_;                                  // 0..n-1, when n is small
+};
+
+// Indices of the `threshold` points of (x = index[i], y[index[i]]) that
+// LTTB keeps, first and last included; all of them if there are no more.
+// An empty index stands for every point of y.
+std::vector<uint32_t> lttb_select(const std::vector<float>& y, const std::vector<uint32_t>& index,
+                                  size_t threshold);
+
+// O(log n) lookups behind zoom and pan. Timestamps and trade indices are
+// ascending, as loaded series and backtest results keep them.
+size_t curve_index_at(const std::vector<BacktestPoint>& curve, int64_t ts_ms);   // first point at or after
+size_t series_index_at(const BarSeries& bars, int64_t ts_ms);                   // first bar at or after
+// [first, last) of the trades with idx in [bar_begin, bar_end).
+std::pair<size_t, size_t> trades_between(const std::vector<Trade>& trades, size_t bar_begin, size_t bar_end);
+
+// Trades on screen bucketed per pixel column and side, so a dense trade set
+// draws one marker per occupied column instead of one per trade. Built once
+// per result and view (see TradeClusters); drawing reads only this.
+struct TradeCluster {
+    uint32_t column;   // pixel column from the plot's left edge
+    int      dir;      // +1 buys, -1 sells
+    uint32_t count;    // trades in this column on this side
+    double   px;       // their mean price (the trade's own when count is 1)
+};
+
+// The clusters of the trades visible in [view_begin, view_end) (fractional
+// curve indices) across cols pixel columns, ordered by column. Trades are
+// found by binary search, so the cost follows the visible trades only.
+void cluster_trades(const BarSeries& bars, const std::vector<BacktestPoint>& curve,
+                    const std::vector<Trade>& trades, double view_begin, double view_end, size_t cols,
+                    std::vector<TradeCluster>& out);
+
+// cluster_trades() memoised on (result version, view, width): the clusters
+// are rebuilt only when one of them changes, not every frame.
+class TradeClusters {
+public:
+    const std::vector<TradeCluster>& update(size_t version, const BarSeries& bars,
+                                            const std::vector<BacktestPoint>& curve,
+                                            const std::vector<Trade>& trades,
+                                            double view_begin, double view_end, size_t cols);
+    size_t builds() const { return builds_; }
+
+private:
+    std::vector<TradeCluster> clusters_;
+    size_t version_ = SIZE_MAX, cols_ = 0, builds_ = 0;
+    double begin_ = 0.0, end_ = 0.0;
+};
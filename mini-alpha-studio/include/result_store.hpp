@@ -0,0 +1,94 @@
+#pragma once
+#include "strategy.hpp"
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Append-only on-disk memo of backtest summaries, keyed by a content hash of
+// the bar series plus every MAParams field. Lets a search skip the pairs an
+// earlier search (in this process or another) already ran.
+//
+// Layout (little-endian):
+//   ResultStoreHeader                      64 bytes
+//   ResultRecord[...]                      80 bytes each, in append order
+//
+// Writers append whole batches under an exclusive flock and realign after a
+// torn tail, so records always start at 64 + 80k; each record carries a
+// checksum and readers (under a shared flock) skip any that don't verify.
+// A header version other than kResultStoreVersion means results from a
+// different backtest engine: the store is then ignored, never appended to.
+
+constexpr uint32_t kResultStoreVersion = 1;
+
+struct ResultStoreHeader {
+    char     magic[8];      // "MARESULT"
+    uint32_t version;       // kResultStoreVersion
+    uint32_t record_size;   // sizeof(ResultRecord)
+    uint64_t reserved[6];
+};
+static_assert(sizeof(ResultStoreHeader) == 64, "store header must stay 64 bytes");
+
+struct ResultRecord {
+    uint64_t data_hash;     // series_hash() of the bars
+    int32_t  fast, slow;
+    float    fee_bps, slippage_bps;
+    double   pnl, max_dd;
+    uint64_t trades, bars;
+    double   ret_mean, ret_std;
+    uint64_t check;         // checksum of the bytes above
+};
+static_assert(sizeof(ResultRecord) == 80, "store records must stay 80 bytes");
+
+// Content hash of every column of the series.
+uint64_t series_hash(const BarSeries& bars);
+
+class ResultStore {
+public:
+    ResultStore() = default;
+    ~ResultStore() { flush(); }
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+
+    // Creates the file (and its directory) if needed and loads every record.
+    // Returns false and fills err if the file can't be used. Not safe to call
+    // while other threads use the store.
+    bool open(const std::string& path, std::string& err);
+    bool is_open() const { return !path_.empty(); }
+    const std::string& path() const { return path_; }
+
+    // Loads records other writers appended since the last open()/refresh().
+    void refresh();
+
+    // Thread-safe. put() makes the result visible to find() at once; it
+    // reaches the file on the next flush().
+    bool find(uint64_t data_hash, const MAParams& p, BacktestStats& out) const;
+    void put(uint64_t data_hash, const MAParams& p, const BacktestStats& s);
+
+    // Appends the pending results in one locked write. False on I/O error
+    // (the results stay in memory and pending).
+    bool flush();
+
+    size_t size() const;   // distinct results known
+
+private:
+    struct Key {
+        uint64_t data_hash;
+        int32_t  fast, slow;
+        uint32_t fee_bits, slip_bits;
+        bool operator==(const Key&) const = default;
+    };
+    struct KeyHash { size_t operator()(const Key& k) const; };
+
+    static Key key_of(uint64_t data_hash, const MAParams& p);
+
+    std::string path_;
+    std::mutex  io_mu_;         // file access and read_to_
+    size_t      read_to_ = 0;   // file offset up to which records are loaded
+    mutable std::shared_mutex index_mu_;
+    std::unordered_map<Key, BacktestStats, KeyHash> index_;
+    std::mutex  pending_mu_;
+    std::vector<ResultRecord> pending_;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Vectorized crossover-signal scan used by the backtests. The sign of
+// (fast - slow) is computed several bars at a time and only bars where the
+// position flips are visited one by one. The instruction set is chosen at
+// runtime: AVX-512 or AVX2 on x86-64, NEON on 64-bit ARM, otherwise a scalar
+// loop. Every variant returns exactly what the scalar loop returns.
+
+enum class SimdIsa { Scalar, Neon, Avx2, Avx512 };
+
+SimdIsa     simd_isa_supported();          // best the CPU (and build) supports
+SimdIsa     simd_isa();                    // in use; defaults to the best supported
+void        set_simd_isa(SimdIsa isa);     // clamped to simd_isa_supported(); for benchmarks
+const char* simd_isa_name(SimdIsa isa);
+
+// Result of scanning bars [begin, end).
+struct CrossoverScan {
+    size_t first  = 0;      // first bar with both MAs defined (end if none)
+    size_t last   = 0;      // one past the last such bar (first if none)
+    size_t valid  = 0;      // bars with both MAs defined
+    bool   finite = true;   // close is finite on every such bar
+    int    pos    = 0;      // position after the range
+
+    // Defined bars form one run [first, last), i.e. no NaN gaps inside.
+    bool dense() const { return valid == last - first; }
+};
+
+// Appends to idx every bar in [begin, end) where a crossover backtest that
+// enters with position pos (0 flat, 1 long) trades: fast > slow while flat
+// buys, fast < slow while long sells. Bars where either MA is NaN are
+// skipped, as in run_ma_crossover. Trades alternate starting with a buy
+// when pos is 0.
+CrossoverScan crossover_scan(const double* close, const double* fast_ma, const double* slow_ma,
+                             size_t begin, size_t end, int pos, std::vector<size_t>& idx);
@@ -1,5 +1,9 @@
 #pragma once
-#include "model.hpp"
+#include "bar_series.hpp"
+#include "signal_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
 // ---- Parameters ----
@@ -32,5 +36,181 @@ struct BacktestResult {
     double sharpe= 0.0;   // placeholder
 };
 
+// Summary of a run without the per-bar output. pnl and max_dd are bit-identical
+// to the BacktestResult fields of the same run.
+struct BacktestStats {
+    double pnl      = 0.0;   // ending equity
+    double max_dd   = 0.0;   // absolute drawdown
+    size_t trades   = 0;     // entries + exits
+    size_t bars     = 0;     // bars with both MAs defined (= curve points)
+    double ret_mean = 0.0;   // mean per-bar equity change
+    double ret_std  = 0.0;   // population stdev of per-bar equity change
+};
+
+// Running mean and population variance of a stream of values, for per-bar
+// equity changes and scenario summaries. Unlike sum/sum-of-squares it
+// doesn't cancel when the mean is large next to the spread: values are
+// summed relative to the first of each block of kBlock, and blocks are
+// merged with the Welford/Chan update, so the per-value cost stays an add
+// and a multiply-add (a division per value would sit on the serial chain).
+// Exact zeros (every bar spent flat) are only counted and merged last, so a
+// replay that counts flat bars with add_zeros() does the same arithmetic as
+// one that add()s each of them.
+struct RunningMoments {
+    static constexpr size_t kBlock = 32;
+
+    double mean = 0.0, m2 = 0.0;   // of the n values merged so far
+    size_t n    = 0;
+    double k = 0.0, s1 = 0.0, s2 = 0.0;   // open block: c values, as sums of x - k
+    size_t c    = 0;
+    size_t zeros = 0;
+
+    void add(double x) {
+        if (x == 0.0) { ++zeros; return; }
+        if (c == 0) k = x;
+        const double y = x - k;
+        s1 += y;
+        s2 += y * y;
+        if (++c == kBlock) flush();
+    }
+    void add_zeros(size_t z) { zeros += z; }
+
+    // Mean and stdev of everything added; 0 when empty.
+    double get_mean() const { return merged().mean; }
+    double get_std()  const {
+        const RunningMoments m = merged();
+        return m.n > 0 ? std::sqrt(std::max(0.0, m.m2 / static_cast<double>(m.n))) : 0.0;
+    }
+
+private:
+    // Folds a group of cnt values with mean bm and squared deviations bm2 in.
+    void merge(size_t cnt, double bm, double bm2) {
+        const double a = static_cast<double>(n), b = static_cast<double>(cnt), ab = a + b;
+        const double d = bm - mean;
+        mean += d * (b / ab);
+        m2   += bm2 + d * d * (a * b / ab);
+        n    += cnt;
+    }
+    void flush() {
+        const double b = static_cast<double>(c);
+        merge(c, k + s1 / b, std::max(0.0, s2 - s1 * (s1 / b)));
+        s1 = s2 = 0.0;
+        c = 0;
+    }
+    RunningMoments merged() const {
+        RunningMoments m = *this;
+        if (m.c > 0) m.flush();
+        if (m.zeros > 0) { m.merge(m.zeros, 0.0, 0.0); m.zeros = 0; }
+        return m;
+    }
+};
+
+// Caller-owned scratch for repeated backtests. Indicator buffers and the
+// result's curve/trades keep their capacity between runs, so once a workspace
+// has seen the largest series (and trade count) of a search, further runs
+// don't touch the heap. Use one workspace per thread.
+struct BacktestWorkspace {
+    std::vector<double> fast_ma, slow_ma;
+    std::vector<size_t> trade_bars;     // crossover_scan output
+    BacktestResult      result;
+};
+
 // Simple moving-average crossover (+ basic costs)
+BacktestResult run_ma_crossover(const BarSeries& bars, const MAParams& p);
+
+// Same, writing into ws.result and returning it; valid until the next run on ws.
+const BacktestResult& run_ma_crossover(const BarSeries& bars, const MAParams& p, BacktestWorkspace& ws);
+
+// Full run over bars [begin, end) only, with both SMAs supplied by the caller
+// as compute_sma() output over all of bars.close: the window starts flat, with
+// its MAs already warmed up on the bars before begin. Trade idx are series
+// indices. Used to test walk-forward folds out of sample.
+const BacktestResult& run_ma_crossover(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                       size_t begin, size_t end, const MAParams& p, BacktestWorkspace& ws);
+
+// Metrics-only run for scoring: no curve, no trade list, no per-bar stores.
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const MAParams& p, BacktestWorkspace& ws);
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const MAParams& p);
+
+// Same, with both SMAs supplied by the caller (e.g. from SmaCache). They must
+// be compute_sma() output for p.fast/p.slow over bars.close.
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                     const MAParams& p);
+
+// Lane-batched stats: scores several parameter sets in one pass over the bars,
+// kBacktestLanes at a time, with each lane's position/cash/equity/peak/drawdown
+// kept in per-lane arrays. out[k] is bit-identical to
+// run_ma_crossover_stats(bars, lanes[k].fast_ma, lanes[k].slow_ma, lanes[k].p).
+constexpr size_t kBacktestLanes = 8;
+
+struct BacktestLane {
+    const double* fast_ma = nullptr;   // compute_sma() output for p.fast
+    const double* slow_ma = nullptr;   // compute_sma() output for p.slow
+    MAParams      p;
+};
+
+void run_ma_crossover_stats_batch(const BarSeries& bars, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out);
+
+// Same over close[0, n), with the lanes' MA pointers indexed alike. Offsetting
+// close and the MAs by the same k backtests the bars from k on with the MAs
+// already warmed up on the bars before k.
+void run_ma_crossover_stats_batch(const double* close, size_t n, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out);
+
+// Same, collecting trade bars in the caller's idx. The bars are scanned
+// kBacktestBlock at a time and idx only ever holds one block's flips, so once
+// it has that much capacity the call doesn't allocate.
+constexpr size_t kBacktestBlock = 1024;
+void run_ma_crossover_stats_batch(const double* close, size_t n, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out, std::vector<size_t>& idx);
+
+// A crossover backtest split at its cost boundary. Where the position flips
+// depends only on the two MAs; the costs only enter the PnL pass over those
+// flips. Sweeps over fee/slippage scan once per (fast, slow) and replay the
+// signal per cost setting.
+struct CrossoverSignal {
+    CrossoverScan       scan;
+    std::vector<size_t> trade_bars;   // bars where the position flips
+};
+
+// The signal of the crossover of fast_ma over slow_ma on close[0, n), both
+// compute_sma() output; out's buffers keep their capacity between calls.
+void scan_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma, size_t n,
+                       CrossoverSignal& out);
+
+// Stats of that signal under p's costs (p.fast/p.slow aren't read), bit-
+// identical to run_ma_crossover_stats on the same MAs with the same params.
+BacktestStats replay_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                                  const CrossoverSignal& sig, const MAParams& p);
+
+// The full result (curve and trades) of that signal under p's costs, written
+// to ws.result: what run_ma_crossover(bars, p) returns for the same MAs,
+// without re-scanning. For when only the costs changed since the scan.
+const BacktestResult& replay_ma_crossover(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                          const CrossoverSignal& sig, const MAParams& p, BacktestWorkspace& ws);
+
+// Cheaper still when r already holds that signal's result under other costs:
+// the trades and the curve's timestamps and prices don't depend on costs, so
+// only the curve's equity, pnl and max_dd are rewritten in place.
+void reprice_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                          const CrossoverSignal& sig, const MAParams& p, BacktestResult& r);
+
+// Same for count cost settings at once, out[k] for costs[k]. The signal's
+// flips are walked once and the per-cost state is updated side by side.
+void replay_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                         const CrossoverSignal& sig, const MAParams* costs, size_t count, BacktestStats* out);
+
+// w-bar simple moving average of close[0, n) into m (resized to n, capacity
+// reused); NAN during warm-up. Every backtest path uses this exact rolling sum.
+void compute_sma(const double* close, size_t n, int w, std::vector<double>& m);
+
+// Record-based adapter: copies into a BarSeries, same results.
 BacktestResult run_ma_crossover(const std::vector<Bar>& bars, const MAParams& p);
+
+// Streaming variant: pulls bars from `in` and keeps only a ring buffer of the
+// last `slow` closes, so memory stays flat regardless of history length.
+// pnl/max_dd (and, with keep_series, curve/trades) match run_ma_crossover on
+// the same bars. Without keep_series the curve and trade list stay empty.
+class BarStream;
+BacktestResult run_ma_crossover_stream(BarStream& in, const MAParams& p, bool keep_series = false);
@@ -0,0 +1,95 @@
+#pragma once
+#include "optimize.hpp"
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// One MAParams field of a sweep: the inclusive range lo, lo + step, ... up to
+// hi, or an explicit list of values. Ranges are never expanded; at(i)
+// computes the i-th value.
+template <class T>
+struct SweepAxis {
+    T      lo{}, step{1};
+    size_t count = 1;
+    std::vector<T> list;   // replaces the range when non-empty
+
+    static SweepAxis range(T lo, T hi, T step = T(1)) {
+        SweepAxis a;
+        a.lo = lo; a.step = step;
+        const double n = step > T(0) ? std::floor((double(hi) - double(lo)) / double(step) + 1e-9) : 0.0;
+        a.count = n >= 0.0 ? size_t(n) + 1 : 0;
+        return a;
+    }
+    static SweepAxis values(std::vector<T> v) {
+        SweepAxis a;
+        a.list = std::move(v);
+        a.count = a.list.size();
+        return a;
+    }
+    static SweepAxis single(T v) { return range(v, v); }
+
+    size_t size() const { return list.empty() ? count : list.size(); }
+    T at(size_t i) const { return list.empty() ? T(lo + step * T(i)) : list[i]; }
+};
+
+// Every MAParams field, swept over its own axis.
+struct SweepSpec {
+    SweepAxis<int>   fast, slow;
+    SweepAxis<float> fee_bps, slippage_bps;
+
+    // All four axes pinned to base's values.
+    static SweepSpec around(const MAParams& base);
+};
+
+// The Cartesian product of a spec's axes, enumerated lazily: point i is
+// computed from i (fast varies slowest, slippage fastest) and nothing is
+// materialized. Points with fast >= slow are part of the space but are
+// never scored.
+class SweepSpace {
+public:
+    explicit SweepSpace(const SweepSpec& spec) : spec_(spec) {}
+    size_t   size() const;
+    size_t   pairs() const { return spec_.fast.size() * spec_.slow.size(); }
+    size_t   costs() const { return spec_.fee_bps.size() * spec_.slippage_bps.size(); }
+    MAParams at(size_t i) const;
+    const SweepSpec& spec() const { return spec_; }
+
+private:
+    SweepSpec spec_;
+};
+
+struct SweepPoint {
+    size_t   index = 0;      // position in SweepSpace order
+    MAParams p;
+    double   score  = -1e300;   // average over datasets, as in the grid search
+    double   pnl    = 0.0;      // averages over datasets
+    double   max_dd = 0.0;
+    double   trades = 0.0;
+};
+
+struct SweepOptions {
+    unsigned                 threads  = 0;         // as in OptOptions
+    OptProgress*             progress = nullptr;   // done/total count points; best unused
+    const std::atomic<bool>* cancel   = nullptr;
+    size_t                   top_k    = 10;
+    // Optional; sees every scored point, from worker threads concurrently.
+    std::function<void(const SweepPoint&)> on_point;
+};
+
+struct SweepResult {
+    std::vector<SweepPoint> top;   // best first; ties to the lower index
+    size_t points        = 0;      // size of the space
+    size_t evaluated     = 0;      // points scored (fast < slow)
+    size_t signal_passes = 0;      // SMA lookups + crossover scans: (fast, slow) x dataset
+    size_t pnl_passes    = 0;      // cost replays of a scanned signal: points x dataset
+    bool   cancelled     = false;
+};
+
+// Scores every point of the space on all datasets (null/empty ones skipped).
+// Work is scheduled per (fast, slow) pair across the pool: each pair's SMAs
+// come from a per-dataset memo and its crossover is scanned once per
+// dataset, then only the PnL pass is re-run for each (fee, slippage) point.
+// Scores are bit-identical to grid_search_fast_slow's for the same params.
+SweepResult sweep_ma_crossover(const std::vector<SeriesPtr>& datasets, const SweepSpec& spec,
+                               const SweepOptions& opt = {});
@@ -0,0 +1,171 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size work-stealing pool. Each worker owns a deque: jobs a worker
+// spawns go to the back of its own deque and it takes them back LIFO, while
+// idle workers steal from the front of other deques (the oldest, usually
+// largest, pieces of work). Jobs submitted from outside the pool go through a
+// shared injection queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0);   // 0 = one per hardware thread
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <class F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto fut  = task->get_future();
+        push([task]{ (*task)(); });
+        return fut;
+    }
+
+    // Calls f(i) for every i in [0, n) and returns when all calls are done.
+    // The range is split recursively into halves that idle workers steal, so
+    // uneven per-index costs balance out. The calling thread runs work too,
+    // which makes this safe to call from inside a pool job. The first
+    // exception thrown by f is rethrown here after the remaining calls finish.
+    template <class F>
+    void parallel_for(size_t n, F&& f);
+
+    unsigned size() const { return static_cast<unsigned>(queues_.size()); }
+
+    // Index of the calling thread among this pool's workers, or -1.
+    int worker_index() const;
+
+    // Process-wide pool shared by loaders and optimizers.
+    static ThreadPool& shared();
+
+private:
+    struct WorkerQueue {
+        std::mutex                        mu;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    struct ForSync {
+        std::atomic<size_t>     remaining{0};
+        std::mutex              mu;
+        std::condition_variable cv;
+        std::exception_ptr      error;
+    };
+
+    void push(std::function<void()> job);
+    bool try_run_one(int self);
+    void worker_loop(unsigned self);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::deque<std::function<void()>>         inject_;   // guarded by mu_
+    std::vector<std::thread>                  workers_;
+    std::atomic<size_t>                       queued_{0};
+    std::mutex                                mu_;
+    std::condition_variable                   cv_;
+    bool                                      stop_ = false;
+};
+
+// The pool a parallel algorithm runs on for its `threads` option: 0 = the
+// shared pool, 1 = none (everything on the caller), n > 1 = n - 1 workers of
+// a pool created in own, plus the caller.
+ThreadPool* pool_for(unsigned threads, std::unique_ptr<ThreadPool>& own);
+
+// One T per thread that can run a parallel_for's tasks on pool (null: the
+// caller only). Worker i has slot 1 + i to itself; slot 0 is shared by every
+// thread outside the pool (the caller, or another parallel_for caller
+// helping out), so local() hands it out under a lock.
+template <class T>
+class PerThread {
+public:
+    class Ref {
+    public:
+        T& operator*()  const { return *v_; }
+        T* operator->() const { return v_; }
+    private:
+        friend class PerThread;
+        Ref(T* v, std::unique_lock<std::mutex> lk) : v_(v), lk_(std::move(lk)) {}
+        T*                           v_;
+        std::unique_lock<std::mutex> lk_;
+    };
+
+    PerThread() = default;
+    explicit PerThread(ThreadPool* pool, const T& init = T{}) { reset(pool, init); }
+    void reset(ThreadPool* pool, const T& init = T{}) {
+        pool_ = pool;
+        slots_.assign(pool ? pool->size() + 1 : 1, init);
+    }
+
+    // The calling thread's slot, held until the Ref goes away.
+    Ref local() {
+        const size_t slot = pool_ ? static_cast<size_t>(pool_->worker_index() + 1) : 0;
+        std::unique_lock<std::mutex> lk(outside_mu_, std::defer_lock);
+        if (slot == 0) lk.lock();
+        return Ref(&slots_[slot], std::move(lk));
+    }
+
+    // Every slot, for merging once the parallel work is done.
+    std::vector<T>&       all()       { return slots_; }
+    const std::vector<T>& all() const { return slots_; }
+
+private:
+    ThreadPool*    pool_ = nullptr;
+    std::vector<T> slots_;
+    std::mutex     outside_mu_;
+};
+
+template <class F>
+void ThreadPool::parallel_for(size_t n, F&& f) {
+    if (n == 0) return;
+
+    // Jobs hold the shared state alive until they return; f itself is
+    // borrowed, since every call to it finishes before this function does.
+    struct State {
+        ForSync                             sync;
+        std::function<void(size_t, size_t)> run;
+    };
+    auto st = std::make_shared<State>();
+    st->sync.remaining = n;
+
+    // Runs [lo, hi): keeps handing the upper half to thieves and finally
+    // calls f on the single index left.
+    State* s  = st.get();
+    auto*  fn = &f;
+    st->run = [this, s, w = std::weak_ptr<State>(st), fn](size_t lo, size_t hi) {
+        while (hi - lo > 1) {
+            const size_t mid = lo + (hi - lo) / 2;
+            push([keep = w.lock(), mid, hi]{ keep->run(mid, hi); });
+            hi = mid;
+        }
+        try {
+            (*fn)(lo);
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(s->sync.mu);
+            if (!s->sync.error) s->sync.error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lk(s->sync.mu);
+        if (--s->sync.remaining == 0) s->sync.cv.notify_all();
+    };
+    push([st, n]{ st->run(0, n); });
+
+    const int self = worker_index();
+    while (st->sync.remaining.load() != 0) {
+        if (try_run_one(self)) continue;
+        std::unique_lock<std::mutex> lk(st->sync.mu);
+        st->sync.cv.wait_for(lk, std::chrono::milliseconds(1),
+                             [&]{ return st->sync.remaining.load() == 0; });
+    }
+    std::lock_guard<std::mutex> lk(st->sync.mu);
+    if (st->sync.error) std::rethrow_exception(st->sync.error);
+}
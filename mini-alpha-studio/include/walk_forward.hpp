@@ -0,0 +1,58 @@
+#pragma once
+#include "optimize.hpp"
+#include <cstddef>
+#include <vector>
+
+// Walk-forward analysis: each series is cut into consecutive test windows;
+// before each one the (fast, slow) pair is picked by a search over the bars
+// preceding it, then traded, unseen, on the test window. Only the test
+// windows make up the out-of-sample (OOS) result.
+struct WalkForwardSpec {
+    size_t train_bars = 756;     // bars searched before each test window (~3y daily)
+    size_t test_bars  = 126;     // bars traded per fold; windows are back to back
+    bool   anchored   = false;   // train from bar 0 every fold instead of a rolling window
+};
+
+struct WalkForwardFold {
+    size_t train_begin = 0, train_end = 0;   // bars the pair was picked on
+    size_t test_begin  = 0, test_end  = 0;   // bars it was then traded on
+    int    fast = 0, slow = 0;               // 0 when nothing was scored (cancelled)
+    double train_score = -1e300;
+    BacktestStats oos;                       // the test window alone, started flat
+    double oos_score = 0.0;
+};
+
+struct WalkForwardSeries {
+    std::vector<WalkForwardFold> folds;
+    // The folds' OOS equity end to end: each fold starts flat, and its
+    // equity is added to where the previous fold ended (a position still
+    // open at a fold's end is valued at its last close, as in pnl).
+    std::vector<BacktestPoint> curve;
+    std::vector<Trade>         trades;   // series indices
+    BacktestStats oos;                   // of the stitched curve
+    double oos_score = 0.0;
+};
+
+struct WalkForwardResult {
+    std::vector<WalkForwardSeries> series;   // search order; empty/too short datasets skipped
+    size_t folds          = 0;
+    double oos_score      = 0.0;   // averages over the series
+    double oos_pnl        = 0.0;
+    size_t evaluations    = 0;     // in-sample backtests over all folds
+    size_t bars_evaluated = 0;
+    bool   cancelled      = false;
+};
+
+// Runs every fold of every series with grid_search_fast_slow (opt.strategy,
+// seed, cancel) on its training window. Folds run in parallel on the pool
+// opt.threads selects, each search on its fold's thread. All folds of a series share one SMA memo
+// over the whole series, so a window's SMA is computed once however many
+// folds use it, and each window starts with its MAs warmed up on the bars
+// before it. opt.progress counts folds (its best is not posted); worker
+// processes and the result store are not used.
+WalkForwardResult walk_forward(const std::vector<SeriesPtr>& datasets,
+                               const MAParams& base,   // fee_bps & slippage
+                               int fast_min, int fast_max,
+                               int slow_min, int slow_max,
+                               const WalkForwardSpec& spec,
+                               const OptOptions& opt = {});
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <vector>
+
+// Fan-out of independent tasks to local worker processes (POSIX only).
+//
+// Workers are fork()ed from the caller, so they see its memory, loaded
+// datasets included, through copy-on-write pages they only read: nothing is
+// copied, reloaded or re-parsed. Tasks are handed out by a lock-free ticket
+// counter in a MAP_SHARED segment and results come back through SharedArray
+// memory the caller allocated before the fan-out. Each worker has its own
+// heap, so there is no allocator contention between them, and a worker that
+// crashes only loses the task it held, which is reported as unfinished.
+//
+// Workers run single-threaded and leave with _exit(): the task function must
+// not use a ThreadPool or take locks another thread of the caller may hold
+// (caches included; compute what the tasks read before the fan-out). It
+// should not allocate either, since malloc's arena locks are such locks:
+// scratch buffers are reserved before the fan-out, and each worker writes
+// its own copy-on-write copy of them.
+
+bool worker_processes_supported();
+
+// n value-initialized Ts, in memory shared with worker processes forked after
+// construction when shared is set (private heap memory otherwise). T must be
+// trivially copyable; the array is never resized.
+template <class T>
+class SharedArray {
+public:
+    SharedArray(size_t n, bool shared);
+    ~SharedArray();
+    SharedArray(const SharedArray&) = delete;
+    SharedArray& operator=(const SharedArray&) = delete;
+
+    T*       data()       { return p_; }
+    const T* data() const { return p_; }
+    T&       operator[](size_t i)       { return p_[i]; }
+    const T& operator[](size_t i) const { return p_[i]; }
+    size_t   size() const { return n_; }
+
+private:
+    T*     p_ = nullptr;
+    size_t n_ = 0;
+    bool   mapped_ = false;
+};
+
+void* map_shared_bytes(size_t bytes);   // zero-filled; nullptr on failure
+void  unmap_shared_bytes(void* p, size_t bytes);
+
+template <class T>
+SharedArray<T>::SharedArray(size_t n, bool shared) : n_(n) {
+    if (shared && n > 0 && (p_ = static_cast<T*>(map_shared_bytes(n * sizeof(T)))))
+        mapped_ = true;
+    else
+        p_ = n > 0 ? new T[n]() : nullptr;
+}
+
+template <class T>
+SharedArray<T>::~SharedArray() {
+    if (mapped_) unmap_shared_bytes(p_, n_ * sizeof(T));
+    else         delete[] p_;
+}
+
+struct ProcessRun {
+    std::vector<size_t> unfinished;   // cancelled, or lost with a crashed or killed worker
+    unsigned workers = 0;             // processes actually started
+    unsigned crashed = 0;             // workers that died abnormally
+    unsigned timed_out = 0;           // workers killed for holding a task past the timeout
+};
+
+// Runs fn(task) for every task in [0, tasks) on up to `workers` forked
+// processes and waits for them. Setting *cancel kills the workers; a worker
+// that spends more than task_timeout_ms (0 = no limit) on one task is killed
+// and the rest carry on. on_progress (called on this thread) sees the count
+// of finished tasks. Without worker process support nothing runs and every
+// task is unfinished.
+ProcessRun run_in_processes(size_t tasks, unsigned workers, const std::function<void(size_t)>& fn,
+                            const std::atomic<bool>* cancel = nullptr,
+                            const std::function<void(size_t)>& on_progress = {},
+                            unsigned task_timeout_ms = 0);
@@ -1,63 +1,478 @@
 #include "strategy.hpp"
+#include "bar_stream.hpp"
+#include "signal_kernels.hpp"
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
-static std::vector<double> sma(const std::vector<Bar>& b, int w) {
-    std::vector<double> m(b.size(), NAN);
-    if (w <= 0 || b.empty()) return m;
+void compute_sma(const double* close, size_t n, int w, std::vector<double>& m) {
+    m.resize(n);
+    if (w <= 0 || n == 0) { std::fill(m.begin(), m.end(), NAN); return; }
+    std::fill(m.begin(), m.begin() + std::min(n, static_cast<size_t>(w) - 1), NAN);
+    // The rolling sum is a serial dependency chain and stays scalar (a
+    // vectorized prefix sum would round differently); splitting off the
+    // warm-up just keeps the steady-state loop free of branches.
+    const size_t ws = static_cast<size_t>(w);
     double s = 0.0;
-    for (size_t i = 0; i < b.size(); ++i) {
-        s += b[i].close;
-        if (i + 1 >= (size_t)w) {
-            if (i + 1 > (size_t)w) s -= b[i - w].close;
-            m[i] = s / w;
-        }
+    size_t i = 0;
+    for (; i < n && i + 1 < ws; ++i) s += close[i];
+    if (i < n) { s += close[i]; m[i] = s / w; ++i; }
+    for (; i < n; ++i) {
+        s += close[i];
+        s -= close[i - ws];
+        m[i] = s / w;
     }
-    return m;
 }
 
 BacktestResult run_ma_crossover(const std::vector<Bar>& bars, const MAParams& p) {
-    BacktestResult r;
-    if (bars.empty() || p.fast <= 0 || p.slow <= 0 || p.fast >= p.slow) return r;
-
-    auto mf = sma(bars, p.fast);
-    auto ms = sma(bars, p.slow);
+    return run_ma_crossover(BarSeries::from_bars(bars), p);
+}
 
-    int    pos   = 0;    // 0 or 1 share
-    double cash  = 0.0;
-    double equity= 0.0;
-    double peak  = 0.0, dd = 0.0;
+// Per-run crossover state. trade() and mark() are the only places the
+// backtest does arithmetic, so every entry point (full, stats-only,
+// batched, streaming) produces the same bits.
+struct CrossoverState {
+    int    pos    = 0;      // 0 or 1 share
+    double cash   = 0.0;
+    double equity = 0.0;
+    double peak   = 0.0, dd = 0.0;
+    double prev   = 0.0;                            // equity at the last mark
+    RunningMoments ret;                             // per-bar equity changes
+    size_t trades = 0, bars = 0;
+    double up = 1.0, dn = 1.0;                      // 1 +/- cost in bps
 
-    auto trade_costed = [&](double px, int dir /*+1 buy, -1 sell*/) {
+    CrossoverState() = default;                     // no costs
+    explicit CrossoverState(const MAParams& p) {
         const double bps = (static_cast<double>(p.fee_bps) + static_cast<double>(p.slippage_bps)) / 10000.0;
-        return (dir > 0) ? px * (1.0 + bps) : px * (1.0 - bps);
-    };
+        up = 1.0 + bps;
+        dn = 1.0 - bps;
+    }
+
+    void trade(double px) {
+        ++trades;
+        if (pos == 0) { cash -= px * up; pos = 1; }
+        else          { cash += px * dn; pos = 0; }
+    }
 
-    for (size_t i = 0; i < bars.size(); ++i) {
-        if (std::isnan(mf[i]) || std::isnan(ms[i])) continue;
+    void mark(double px) {
+        equity = cash + pos * px;
+        peak   = std::max(peak, equity);
+        dd     = std::max(dd, peak - equity);
 
-        const double px = bars[i].close;
-        int want = pos;
-        if (mf[i] > ms[i] && pos == 0) want = 1;
-        if (mf[i] < ms[i] && pos == 1) want = 0;
+        ret.add(equity - prev);
+        prev = equity;
+        ++bars;
+    }
+
+    // k more bars marked flat after a mark: equity, and so every state
+    // but the counts, stays as it is.
+    void flat(size_t k) {
+        bars += k;
+        ret.add_zeros(k);
+    }
 
-        if (want != pos) {
+    BacktestStats finish() const {
+        BacktestStats st;
+        st.pnl    = equity;
+        st.max_dd = dd;
+        st.trades = trades;
+        st.bars   = bars;
+        if (bars > 0) {
+            st.ret_mean = ret.get_mean();
+            st.ret_std  = ret.get_std();
+        }
+        return st;
+    }
+};
+
+BacktestResult run_ma_crossover(const BarSeries& bars, const MAParams& p) {
+    BacktestWorkspace ws;
+    run_ma_crossover(bars, p, ws);
+    return std::move(ws.result);
+}
+
+// Marks every defined bar of a scanned range, trading at the scanned trade
+// bars, so on_point can see each bar's equity.
+template <class OnTrade, class OnPoint>
+static BacktestStats mark_pass(const double* close, const double* mf, const double* ms,
+                               const CrossoverScan& sc, const size_t* t, const size_t* t_end,
+                               const MAParams& p, OnTrade&& on_trade, OnPoint&& on_point) {
+    CrossoverState s(p);
+    const bool dense = sc.dense();
+
+    for (size_t i = sc.first; i < sc.last; ++i) {
+        if (!dense && (std::isnan(mf[i]) || std::isnan(ms[i]))) continue;
+
+        const double px = close[i];
+        if (t != t_end && *t == i) {
             // Record trade BEFORE modifying pos/cash
-            r.trades.push_back(Trade{ i, bars[i].ts_ms, px, (want==1 ? +1 : -1) });
+            on_trade(i, px, s.pos == 0 ? +1 : -1);
+            s.trade(px);
+            ++t;
+        }
+        s.mark(px);
+        on_point(i, px, s.equity);
+    }
+    return s.finish();
+}
+
+// Full pass: the trade bars come from the vectorized crossover_scan, then
+// mark_pass walks the bars.
+template <class OnTrade, class OnPoint>
+static BacktestStats crossover_pass(const double* close, const double* mf, const double* ms, size_t n,
+                                    const MAParams& p, std::vector<size_t>& idx,
+                                    OnTrade&& on_trade, OnPoint&& on_point) {
+    idx.clear();
+    const CrossoverScan sc = crossover_scan(close, mf, ms, 0, n, 0, idx);
+    return mark_pass(close, mf, ms, sc, idx.data(), idx.data() + idx.size(), p,
+                     std::forward<OnTrade>(on_trade), std::forward<OnPoint>(on_point));
+}
+
+// Stats-only replay of one scanned range. While flat, equity is cash + 0 * px
+// == cash on every bar, so once the first bar of a flat run is marked the
+// rest would change nothing but the bar count; they are counted, not
+// visited. That needs a finite close and no NaN gaps; otherwise (or while
+// long) bars are marked one by one.
+static void replay_stats(CrossoverState& s, const double* close, const double* mf, const double* ms,
+                         const CrossoverScan& sc, const size_t* t, const size_t* t_end) {
+    if (sc.valid == 0) return;
 
-            if (want == 1) { cash -= trade_costed(px, +1); pos = 1; }
-            else           { cash += trade_costed(px, -1); pos = 0; }
+    if (!sc.dense() || !sc.finite) {
+        for (size_t i = sc.first; i < sc.last; ++i) {
+            if (std::isnan(mf[i]) || std::isnan(ms[i])) continue;
+            if (t != t_end && *t == i) { s.trade(close[i]); ++t; }
+            s.mark(close[i]);
         }
+        return;
+    }
 
-        equity = cash + pos * px;
-        peak   = std::max(peak, equity);
-        dd     = std::max(dd, peak - equity);
+    size_t i = sc.first;
+    while (i < sc.last) {
+        const size_t next = t != t_end ? *t : sc.last;
+        if (s.pos == 0) {
+            if (i < next) { s.mark(close[i]); s.flat(next - i - 1); i = next; }
+        } else {
+            for (; i < next; ++i) s.mark(close[i]);
+        }
+        if (i < sc.last) { s.trade(close[i]); s.mark(close[i]); ++i; ++t; }
+    }
+}
 
-        r.curve.push_back({bars[i].ts_ms, px, equity});
+static BacktestStats crossover_stats(const double* close, const double* mf, const double* ms, size_t n,
+                                     const MAParams& p, std::vector<size_t>& idx) {
+    CrossoverState s(p);
+    idx.clear();
+    const CrossoverScan sc = crossover_scan(close, mf, ms, 0, n, 0, idx);
+    replay_stats(s, close, mf, ms, sc, idx.data(), idx.data() + idx.size());
+    return s.finish();
+}
+
+// Stats for kBacktestLanes parameter sets in one sweep over the bars.
+// Each lane's CrossoverState is kept between blocks; within a block each
+// lane is scanned and replayed like crossover_stats, so results match it bit
+// for bit.
+static void crossover_pass_lanes(const double* close, size_t n, const BacktestLane* lanes,
+                                 BacktestStats* out, std::vector<size_t>& idx) {
+    constexpr size_t L = kBacktestLanes;
+    CrossoverState st[L];   // per-lane state between blocks
+
+    for (size_t l = 0; l < L; ++l) {
+        st[l] = CrossoverState(lanes[l].p);
+    }
+    // First bar any lane has both MAs on. Offset MAs may be warmed up from
+    // bar 0, so this is found from the data rather than from p.slow.
+    size_t start = n;
+    for (size_t l = 0; l < L; ++l) {
+        size_t i = 0;
+        while (i < start && (std::isnan(lanes[l].fast_ma[i]) || std::isnan(lanes[l].slow_ma[i]))) ++i;
+        start = i;
+    }
+
+    // The bars are walked in blocks small enough to stay in L1; every lane
+    // runs over the block before the next block is touched, so close[] is
+    // read from memory once for the whole group.
+    for (size_t b0 = start; b0 < n; b0 += kBacktestBlock) {
+        const size_t b1 = std::min(n, b0 + kBacktestBlock);
+        for (size_t l = 0; l < L; ++l) {
+            // A local copy, so the replay keeps it in registers rather than
+            // storing through memory close[] might alias.
+            CrossoverState s = st[l];
+            idx.clear();
+            const CrossoverScan sc = crossover_scan(close, lanes[l].fast_ma, lanes[l].slow_ma, b0, b1, s.pos, idx);
+            replay_stats(s, close, lanes[l].fast_ma, lanes[l].slow_ma, sc, idx.data(), idx.data() + idx.size());
+            st[l] = s;
+        }
     }
 
-    r.pnl    = equity;
-    r.max_dd = dd;
+    for (size_t l = 0; l < L; ++l) out[l] = st[l].finish();
+}
+
+static bool valid_params(size_t n, const MAParams& p) {
+    return n > 0 && p.fast > 0 && p.slow > 0 && p.fast < p.slow;
+}
+
+static bool valid_params(const BarSeries& bars, const MAParams& p) {
+    return valid_params(bars.size(), p);
+}
+
+const BacktestResult& run_ma_crossover(const BarSeries& bars, const MAParams& p, BacktestWorkspace& ws) {
+    BacktestResult& r = ws.result;
+    r.curve.clear();
+    r.trades.clear();
+    r.pnl = r.max_dd = r.sharpe = 0.0;
+    if (!valid_params(bars, p)) return r;
+
+    const double*  close = bars.close.data();
+    const int64_t* ts    = bars.ts_ms.data();
+    compute_sma(close, bars.size(), p.fast, ws.fast_ma);
+    compute_sma(close, bars.size(), p.slow, ws.slow_ma);
+
+    // Every bar from slow-1 on produces a curve point.
+    r.curve.reserve(bars.size() - std::min(bars.size(), static_cast<size_t>(p.slow) - 1));
+
+    const BacktestStats st = crossover_pass(close, ws.fast_ma.data(), ws.slow_ma.data(), bars.size(), p,
+        ws.trade_bars,
+        [&](size_t i, double px, int dir) { r.trades.push_back(Trade{ i, ts[i], px, dir }); },
+        [&](size_t i, double px, double eq) { r.curve.push_back({ts[i], px, eq}); });
+
+    r.pnl    = st.pnl;
+    r.max_dd = st.max_dd;
     r.sharpe = 0.0; // simple
     return r;
 }
+
+const BacktestResult& run_ma_crossover(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                       size_t begin, size_t end, const MAParams& p, BacktestWorkspace& ws) {
+    BacktestResult& r = ws.result;
+    r.curve.clear();
+    r.trades.clear();
+    r.pnl = r.max_dd = r.sharpe = 0.0;
+    end = std::min(end, bars.size());
+    if (begin >= end || !valid_params(bars, p)) return r;
+
+    const double*  close = bars.close.data() + begin;
+    const int64_t* ts    = bars.ts_ms.data() + begin;
+    r.curve.reserve(end - begin);
+
+    const BacktestStats st = crossover_pass(close, fast_ma + begin, slow_ma + begin, end - begin, p,
+        ws.trade_bars,
+        [&](size_t i, double px, int dir) { r.trades.push_back(Trade{ begin + i, ts[i], px, dir }); },
+        [&](size_t i, double px, double eq) { r.curve.push_back({ts[i], px, eq}); });
+
+    r.pnl    = st.pnl;
+    r.max_dd = st.max_dd;
+    return r;
+}
+
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const MAParams& p, BacktestWorkspace& ws) {
+    if (!valid_params(bars, p)) return BacktestStats{};
+
+    const double* close = bars.close.data();
+    compute_sma(close, bars.size(), p.fast, ws.fast_ma);
+    compute_sma(close, bars.size(), p.slow, ws.slow_ma);
+    return crossover_stats(close, ws.fast_ma.data(), ws.slow_ma.data(), bars.size(), p, ws.trade_bars);
+}
+
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                     const MAParams& p) {
+    if (!valid_params(bars, p)) return BacktestStats{};
+    std::vector<size_t> idx;
+    return crossover_stats(bars.close.data(), fast_ma, slow_ma, bars.size(), p, idx);
+}
+
+void run_ma_crossover_stats_batch(const BarSeries& bars, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out) {
+    run_ma_crossover_stats_batch(bars.close.data(), bars.size(), lanes, count, out);
+}
+
+void run_ma_crossover_stats_batch(const double* close, size_t n, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out) {
+    std::vector<size_t> idx;
+    run_ma_crossover_stats_batch(close, n, lanes, count, out, idx);
+}
+
+void run_ma_crossover_stats_batch(const double* close, size_t n, const BacktestLane* lanes, size_t count,
+                                  BacktestStats* out, std::vector<size_t>& idx) {
+    // Invalid lanes get empty stats like the scalar path; the rest are packed
+    // into full groups, padding the last group with copies of a valid lane.
+    BacktestLane group[kBacktestLanes];
+    size_t       slot[kBacktestLanes];
+    BacktestStats res[kBacktestLanes];
+    size_t k = 0;
+
+    auto flush = [&]() {
+        for (size_t l = k; l < kBacktestLanes; ++l) group[l] = group[0];
+        crossover_pass_lanes(close, n, group, res, idx);
+        for (size_t l = 0; l < k; ++l) out[slot[l]] = res[l];
+        k = 0;
+    };
+
+    for (size_t j = 0; j < count; ++j) {
+        if (!valid_params(n, lanes[j].p)) { out[j] = BacktestStats{}; continue; }
+        group[k] = lanes[j];
+        slot[k]  = j;
+        if (++k == kBacktestLanes) flush();
+    }
+    if (k > 0) flush();
+}
+
+void scan_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma, size_t n,
+                       CrossoverSignal& out) {
+    out.trade_bars.clear();
+    out.scan = crossover_scan(close, fast_ma, slow_ma, 0, n, 0, out.trade_bars);
+}
+
+BacktestStats replay_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                                  const CrossoverSignal& sig, const MAParams& p) {
+    CrossoverState s(p);
+    const size_t* t = sig.trade_bars.data();
+    replay_stats(s, close, fast_ma, slow_ma, sig.scan, t, t + sig.trade_bars.size());
+    return s.finish();
+}
+
+const BacktestResult& replay_ma_crossover(const BarSeries& bars, const double* fast_ma, const double* slow_ma,
+                                          const CrossoverSignal& sig, const MAParams& p, BacktestWorkspace& ws) {
+    BacktestResult& r = ws.result;
+    r.curve.clear();
+    r.trades.clear();
+    r.pnl = r.max_dd = r.sharpe = 0.0;
+    if (!valid_params(bars, p)) return r;
+
+    // The signal knows both sizes up front: write in place, no push_back.
+    const int64_t* ts = bars.ts_ms.data();
+    r.curve.resize(sig.scan.valid);
+    r.trades.resize(sig.trade_bars.size());
+    BacktestPoint* pt = r.curve.data();
+    Trade*         tr = r.trades.data();
+    const size_t* t = sig.trade_bars.data();
+    const BacktestStats st = mark_pass(bars.close.data(), fast_ma, slow_ma, sig.scan, t, t + sig.trade_bars.size(), p,
+        [&](size_t i, double px, int dir) { *tr++ = Trade{ i, ts[i], px, dir }; },
+        [&](size_t i, double px, double eq) { *pt++ = BacktestPoint{ts[i], px, eq}; });
+
+    r.pnl    = st.pnl;
+    r.max_dd = st.max_dd;
+    return r;
+}
+
+void reprice_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                          const CrossoverSignal& sig, const MAParams& p, BacktestResult& r) {
+    if (r.curve.size() != sig.scan.valid) return;
+    BacktestPoint* pt = r.curve.data();
+    const size_t* t = sig.trade_bars.data();
+    const BacktestStats st = mark_pass(close, fast_ma, slow_ma, sig.scan, t, t + sig.trade_bars.size(), p,
+        [](size_t, double, int) {},
+        [&](size_t, double, double eq) { (pt++)->equity = eq; });
+    r.pnl    = st.pnl;
+    r.max_dd = st.max_dd;
+}
+
+void replay_ma_crossover(const double* close, const double* fast_ma, const double* slow_ma,
+                         const CrossoverSignal& sig, const MAParams* costs, size_t count, BacktestStats* out) {
+    const CrossoverScan& sc = sig.scan;
+    if (!sc.dense() || !sc.finite || sc.valid == 0) {
+        for (size_t k = 0; k < count; ++k) out[k] = replay_ma_crossover(close, fast_ma, slow_ma, sig, costs[k]);
+        return;
+    }
+
+    // Position, trade and bar counts are the signal's and shared by every
+    // cost; only the cash-derived state is per lane. Each lane does exactly
+    // CrossoverState's operations in its order, so results are bit-identical.
+    constexpr size_t L = kBacktestLanes;
+    for (size_t k0 = 0; k0 < count; k0 += L) {
+        const size_t m = std::min(L, count - k0);
+        alignas(64) double up[L], dn[L], cash[L], equity[L], peak[L], dd[L], prev[L];
+        RunningMoments ret[L];
+        for (size_t l = 0; l < L; ++l) {
+            const CrossoverState s(costs[k0 + std::min(l, m - 1)]);
+            up[l] = s.up; dn[l] = s.dn;
+            cash[l] = equity[l] = peak[l] = dd[l] = prev[l] = 0.0;
+        }
+        auto mark = [&](double px, int pos) {
+            for (size_t l = 0; l < L; ++l) {
+                equity[l] = cash[l] + pos * px;
+                peak[l]   = std::max(peak[l], equity[l]);
+                dd[l]     = std::max(dd[l], peak[l] - equity[l]);
+            }
+            for (size_t l = 0; l < L; ++l) { ret[l].add(equity[l] - prev[l]); prev[l] = equity[l]; }
+        };
+
+        // The dense-range walk of replay_stats: flat runs are marked once.
+        const size_t* t     = sig.trade_bars.data();
+        const size_t* t_end = t + sig.trade_bars.size();
+        int    pos = 0;
+        size_t i   = sc.first;
+        while (i < sc.last) {
+            const size_t next = t != t_end ? *t : sc.last;
+            if (pos == 0) {
+                if (i < next) {
+                    mark(close[i], pos);
+                    for (size_t l = 0; l < L; ++l) ret[l].add_zeros(next - i - 1);
+                    i = next;
+                }
+            } else {
+                for (; i < next; ++i) mark(close[i], pos);
+            }
+            if (i < sc.last) {
+                const double px = close[i];
+                for (size_t l = 0; l < L; ++l) {
+                    if (pos == 0) cash[l] -= px * up[l];
+                    else          cash[l] += px * dn[l];
+                }
+                pos ^= 1;
+                mark(px, pos); ++i; ++t;
+            }
+        }
+        for (size_t l = 0; l < m; ++l) {
+            CrossoverState s(costs[k0 + l]);
+            s.equity = equity[l]; s.dd = dd[l]; s.ret = ret[l];
+            s.trades = sig.trade_bars.size(); s.bars = sc.valid;   // every defined bar, dense range
+            out[k0 + l] = s.finish();
+        }
+    }
+}
+
+BacktestStats run_ma_crossover_stats(const BarSeries& bars, const MAParams& p) {
+    BacktestWorkspace ws;
+    return run_ma_crossover_stats(bars, p, ws);
+}
+
+BacktestResult run_ma_crossover_stream(BarStream& in, const MAParams& p, bool keep_series) {
+    BacktestResult r;
+    if (p.fast <= 0 || p.slow <= 0 || p.fast >= p.slow) return r;
+
+    // ring[i % slow] holds close[i]; the slot about to be overwritten is
+    // close[i - slow], and close[i - fast] sits (slow - fast) slots ahead of it.
+    std::vector<double> ring(static_cast<size_t>(p.slow), 0.0);
+    const size_t wf = static_cast<size_t>(p.fast), ws = static_cast<size_t>(p.slow);
+    double sf = 0.0, ss = 0.0;   // running sums, updated exactly like compute_sma()
+
+    CrossoverState s(p);
+    Bar b;
+    for (size_t i = 0; in.next(b); ++i) {
+        const double px = b.close;
+        const size_t slot = i % ws;
+
+        sf += px;
+        if (i + 1 > wf) sf -= ring[(i - wf) % ws];
+        ss += px;
+        if (i + 1 > ws) ss -= ring[slot];
+        ring[slot] = px;
+
+        const double mf = (i + 1 >= wf) ? sf / p.fast : NAN;
+        const double ms = (i + 1 >= ws) ? ss / p.slow : NAN;
+        if (std::isnan(mf) || std::isnan(ms)) continue;
+
+        if ((mf > ms && s.pos == 0) || (mf < ms && s.pos == 1)) {
+            if (keep_series) r.trades.push_back(Trade{ i, b.ts_ms, px, s.pos == 0 ? +1 : -1 });
+            s.trade(px);
+        }
+        s.mark(px);
+
+        if (keep_series) r.curve.push_back({b.ts_ms, px, s.equity});
+    }
+
+    r.pnl    = s.equity;
+    r.max_dd = s.dd;
+    r.sharpe = 0.0;
+    return r;
+}
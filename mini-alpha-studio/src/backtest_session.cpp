@@ -0,0 +1,40 @@
+#include "backtest_session.hpp"
+#include <chrono>
+
+BacktestSession::BacktestSession(SeriesPtr series)
+    : sma_(series ? std::move(series) : std::make_shared<const BarSeries>())
+{
+}
+
+const BacktestResult& BacktestSession::update(const MAParams& p){
+    const bool signal = !scanned_ || p.fast != p_.fast || p.slow != p_.slow;
+    const bool costs  = p.fee_bps != p_.fee_bps || p.slippage_bps != p_.slippage_bps;
+    if (!signal && !costs) return ws_.result;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    p_ = p;
+    ++version_;
+    const BarSeries& bars = sma_.series();
+    if (signal){
+        ++signal_version_;
+        scanned_ = false;
+        if (p.fast > 0 && p.slow > 0 && p.fast < p.slow && !bars.empty()){
+            fast_ma_ = sma_.get(p.fast, ws_.fast_ma);
+            slow_ma_ = sma_.get(p.slow, ws_.slow_ma);
+            scan_ma_crossover(bars.close.data(), fast_ma_, slow_ma_, bars.size(), sig_);
+            scanned_ = true;
+            ++signal_runs_;
+        }
+    }
+    if (scanned_){
+        if (signal) replay_ma_crossover(bars, fast_ma_, slow_ma_, sig_, p, ws_);
+        else        reprice_ma_crossover(bars.close.data(), fast_ma_, slow_ma_, sig_, p, ws_.result);
+        ++pnl_runs_;
+    } else {
+        // Invalid params: the empty result run_ma_crossover returns. The
+        // next update rescans whatever changed.
+        ws_.result = BacktestResult{};
+    }
+    last_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return ws_.result;
+}
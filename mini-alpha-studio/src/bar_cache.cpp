@@ -0,0 +1,123 @@
+#include "bar_cache.hpp"
+#include "mapped_file.hpp"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#if defined(_WIN32)
+  #include <process.h>
+  #define getpid _getpid
+#else
+  #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static const char kMagic[8] = {'M','A','B','A','R','S','\0','\0'};
+
+static inline uint64_t fnv1a(uint64_t h, uint64_t v){
+  for (int i = 0; i < 8; ++i){ h ^= (v >> (8 * i)) & 0xff; h *= 1099511628211ULL; }
+  return h;
+}
+
+static inline uint64_t stamp_check(uint64_t size, int64_t mtime){
+  uint64_t h = 1469598103934665603ULL;
+  h = fnv1a(h, kBarCacheVersion);
+  h = fnv1a(h, size);
+  h = fnv1a(h, static_cast<uint64_t>(mtime));
+  return h;
+}
+
+static inline size_t pad8(size_t n){ return (n + 7) & ~size_t(7); }
+
+static bool source_stamp(const std::string& csv_path, uint64_t& size, int64_t& mtime){
+  std::error_code ec;
+  size = fs::file_size(csv_path, ec);
+  if (ec) return false;
+  auto t = fs::last_write_time(csv_path, ec);
+  if (ec) return false;
+  mtime = static_cast<int64_t>(t.time_since_epoch().count());
+  return true;
+}
+
+std::string bar_cache_path(const std::string& csv_path){ return csv_path + ".bars"; }
+
+bool read_bar_cache(const std::string& csv_path, BarSeries& out, std::string& warn){
+  out.clear();
+  if constexpr (std::endian::native != std::endian::little) return false;
+
+  uint64_t size = 0; int64_t mtime = 0;
+  if (!source_stamp(csv_path, size, mtime)) return false;
+
+  MappedFile mf; std::string err;
+  if (!fs::exists(bar_cache_path(csv_path)) || !mf.open(bar_cache_path(csv_path), err)) return false;
+  if (mf.size() < sizeof(BarCacheHeader)) return false;
+
+  BarCacheHeader h;
+  std::memcpy(&h, mf.data(), sizeof(h));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kBarCacheVersion ||
+      h.columns != 6) return false;
+  if (h.src_size != size || h.src_mtime != mtime || h.src_check != stamp_check(size, mtime)) return false;
+
+  const size_t n    = static_cast<size_t>(h.count);
+  const size_t body = sizeof(h) + pad8(h.warn_len);
+  if (n > (mf.size() - sizeof(h)) / (6 * 8) || mf.size() != body + n * 6 * 8) return false;
+
+  const char* p = mf.data() + sizeof(h);
+  warn.assign(p, h.warn_len);
+  p = mf.data() + body;
+
+  // Columns are copied straight into the series; no per-bar work.
+  out.resize(n);
+  auto get = [&](auto& col){ std::memcpy(col.data(), p, n * 8); p += n * 8; };
+  get(out.ts_ms); get(out.open); get(out.high); get(out.low); get(out.close); get(out.volume);
+  return true;
+}
+
+bool write_bar_cache(const std::string& csv_path, const BarSeries& bars,
+                     const std::string& warn){
+  if constexpr (std::endian::native != std::endian::little) return false;
+
+  uint64_t size = 0; int64_t mtime = 0;
+  if (!source_stamp(csv_path, size, mtime)) return false;
+
+  BarCacheHeader h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version   = kBarCacheVersion;
+  h.columns   = 6;
+  h.count     = bars.size();
+  h.src_size  = size;
+  h.src_mtime = mtime;
+  h.src_check = stamp_check(size, mtime);
+  h.warn_len  = static_cast<uint32_t>(warn.size());
+
+  // Unique temp name so concurrent loaders of the same CSV don't collide:
+  // the pid tells processes (and forked workers) apart, the thread id the
+  // threads of one process.
+  const std::string final_path = bar_cache_path(csv_path);
+  const std::string tmp_path = final_path + ".tmp" + std::to_string(getpid()) + "." +
+      std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    const char zeros[8] = {};
+    f.write(warn.data(), static_cast<std::streamsize>(warn.size()));
+    f.write(zeros, static_cast<std::streamsize>(pad8(warn.size()) - warn.size()));
+
+    auto put = [&](const auto& col){
+      f.write(reinterpret_cast<const char*>(col.data()), static_cast<std::streamsize>(col.size() * 8));
+    };
+    put(bars.ts_ms); put(bars.open); put(bars.high);
+    put(bars.low);   put(bars.close); put(bars.volume);
+    if (!f){ f.close(); std::error_code ec; fs::remove(tmp_path, ec); return false; }
+  }
+
+  std::error_code ec;
+  fs::rename(tmp_path, final_path, ec);
+  if (ec){ fs::remove(tmp_path, ec); return false; }
+  return true;
+}
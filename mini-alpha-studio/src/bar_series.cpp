@@ -0,0 +1,38 @@
+#include "bar_series.hpp"
+#include <algorithm>
+
+template <class F>
+static void for_each_column(BarSeries& s, F&& f){
+    f(s.ts_ms); f(s.open); f(s.high); f(s.low); f(s.close); f(s.volume);
+}
+
+void BarSeries::reserve(size_t n) { for_each_column(*this, [n](auto& c){ c.reserve(n); }); }
+void BarSeries::resize(size_t n)  { for_each_column(*this, [n](auto& c){ c.resize(n); }); }
+void BarSeries::clear()           { for_each_column(*this, [](auto& c){ c.clear(); }); }
+void BarSeries::reverse()         { for_each_column(*this, [](auto& c){ std::reverse(c.begin(), c.end()); }); }
+
+void BarSeries::append(const BarSeries& o) {
+    ts_ms.insert(ts_ms.end(), o.ts_ms.begin(), o.ts_ms.end());
+    open.insert(open.end(), o.open.begin(), o.open.end());
+    high.insert(high.end(), o.high.begin(), o.high.end());
+    low.insert(low.end(), o.low.begin(), o.low.end());
+    close.insert(close.end(), o.close.begin(), o.close.end());
+    volume.insert(volume.end(), o.volume.begin(), o.volume.end());
+}
+
+BarSeries BarSeries::from_bars(const std::vector<Bar>& bars) {
+    BarSeries s;
+    s.resize(bars.size());
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const Bar& b = bars[i];
+        s.ts_ms[i] = b.ts_ms; s.open[i] = b.open; s.high[i] = b.high;
+        s.low[i] = b.low; s.close[i] = b.close; s.volume[i] = b.volume;
+    }
+    return s;
+}
+
+std::vector<Bar> BarSeries::to_bars() const {
+    std::vector<Bar> out(size());
+    for (size_t i = 0; i < out.size(); ++i) out[i] = (*this)[i];
+    return out;
+}
@@ -0,0 +1,221 @@
+// Large-file offsets on 32-bit targets (the Pi build) come from
+// _FILE_OFFSET_BITS=64, which CMakeLists.txt sets for every target.
+#include "bar_stream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sys/types.h>
+
+static int seek_to(std::FILE* f, int64_t off){
+#if defined(_WIN32)
+  return _fseeki64(f, off, SEEK_SET);
+#else
+  return fseeko(f, static_cast<off_t>(off), SEEK_SET);
+#endif
+}
+
+static int64_t file_length(std::FILE* f){
+#if defined(_WIN32)
+  if (_fseeki64(f, 0, SEEK_END) != 0) return -1;
+  return _ftelli64(f);
+#else
+  if (fseeko(f, 0, SEEK_END) != 0) return -1;
+  return static_cast<int64_t>(ftello(f));
+#endif
+}
+
+static inline void strip_cr(const char* lb, const char*& le){
+  if (le > lb && le[-1] == '\r') --le;
+}
+
+BarStream::BarStream(size_t buffer_bytes) : buf_(std::max<size_t>(buffer_bytes, 4096)) {}
+
+BarStream::~BarStream(){ close(); }
+
+void BarStream::close(){
+  if (f_) std::fclose(f_);
+  f_ = nullptr;
+  schema_ = CsvSchema::Unknown;
+  reverse_ = false;
+  lo_ = hi_ = 0; eof_ = true; skip_ = false;
+  count_ = 0; warn_.clear();
+}
+
+bool BarStream::open(const std::string& path, std::string& err){
+  close();
+  err.clear();
+  f_ = std::fopen(path.c_str(), "rb");
+  if (!f_){ err = "Cannot open " + path; return false; }
+
+  const int64_t size = file_length(f_);
+  if (size < 0){ err = "Cannot read " + path; close(); return false; }
+  if (size == 0){ err = "Empty file"; close(); return false; }
+
+  // ---- Header ----
+  data_begin_ = 0; data_end_ = size;
+  rewind_forward();
+  const char* lb = nullptr; const char* le = nullptr;
+  if (!fwd_line(lb, le)){ err = "Empty file"; close(); return false; }
+  std::string header(lb, le);
+  data_begin_ = file_pos_ - static_cast<int64_t>(hi_ - lo_);
+  if (skip_){ err = "Unrecognized header: " + header; close(); return false; }
+
+  schema_ = detect_csv_schema(header);
+  if (schema_ == CsvSchema::Unknown){ err = "Unrecognized header: " + header; close(); return false; }
+
+  {
+    char c = 0;
+    ends_nl_ = size > data_begin_ && seek_to(f_, size - 1) == 0 && std::fread(&c, 1, 1, f_) == 1 && c == '\n';
+  }
+
+  // ---- Newest-first detection: first vs. last valid row, as load_bar_series does ----
+  if (schema_ == CsvSchema::DateCloseLast){
+    Bar first{}, last{}; bool have_first = false, have_last = false;
+    rewind_forward();
+    while (!have_first && fwd_line(lb, le)){
+      strip_cr(lb, le);
+      have_first = le > lb && !parse_csv_row(lb, le, schema_, first);
+    }
+    rewind_reverse();
+    while (!have_last && rev_line(lb, le)){
+      strip_cr(lb, le);
+      have_last = le > lb && !parse_csv_row(lb, le, schema_, last);
+    }
+    reverse_ = have_first && have_last && first.ts_ms > last.ts_ms;
+  }
+
+  // Reverse mode numbers lines from the end, so it needs the line count.
+  total_lines_ = 0;
+  if (reverse_){
+    int64_t pos = data_begin_;
+    seek_to(f_, pos);
+    while (pos < data_end_){
+      const size_t want = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(buf_.size()), data_end_ - pos));
+      const size_t n = std::fread(buf_.data(), 1, want, f_);
+      if (n == 0) break;
+      total_lines_ += static_cast<size_t>(std::count(buf_.data(), buf_.data() + n, '\n'));
+      pos += static_cast<int64_t>(n);
+    }
+    if (data_end_ > data_begin_ && !ends_nl_) ++total_lines_;
+  }
+
+  if (reverse_) rewind_reverse(); else rewind_forward();
+  line_ = reverse_ ? total_lines_ + 2 : 1;
+  last_ts_ = -1;
+  count_ = 0;
+  warn_.clear();
+  return true;
+}
+
+void BarStream::rewind_forward(){
+  lo_ = hi_ = 0;
+  file_pos_ = data_begin_;
+  eof_ = file_pos_ >= data_end_;
+  skip_ = false;
+  seek_to(f_, file_pos_);
+}
+
+void BarStream::rewind_reverse(){
+  lo_ = hi_ = buf_.size();
+  file_pos_ = data_end_ - (ends_nl_ ? 1 : 0);
+  skip_ = false;
+}
+
+bool BarStream::fwd_line(const char*& lb, const char*& le){
+  char* b = buf_.data();
+  for (;;){
+    if (lo_ < hi_){
+      const char* nl = static_cast<const char*>(std::memchr(b + lo_, '\n', hi_ - lo_));
+      if (nl){
+        const size_t start = lo_;
+        lo_ = static_cast<size_t>(nl - b) + 1;
+        if (skip_){ skip_ = false; continue; }
+        lb = b + start; le = nl;
+        return true;
+      }
+    }
+    if (eof_){
+      if (lo_ < hi_ && !skip_){ lb = b + lo_; le = b + hi_; lo_ = hi_; return true; }
+      skip_ = false; lo_ = hi_;
+      return false;
+    }
+    // Refill: keep the partial line, read more behind it.
+    if (skip_) lo_ = hi_;
+    if (lo_ > 0){ std::memmove(b, b + lo_, hi_ - lo_); hi_ -= lo_; lo_ = 0; }
+    if (hi_ == buf_.size()){
+      // Line longer than the buffer: hand out the head (it fails to parse)
+      // and drop the rest up to the next newline.
+      lb = b; le = b + hi_; lo_ = hi_ = 0; skip_ = true;
+      return true;
+    }
+    const size_t want = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(buf_.size() - hi_),
+                                                              data_end_ - file_pos_));
+    const size_t n = std::fread(b + hi_, 1, want, f_);
+    hi_ += n; file_pos_ += static_cast<int64_t>(n);
+    if (n == 0 || file_pos_ >= data_end_) eof_ = true;
+  }
+}
+
+bool BarStream::rev_line(const char*& lb, const char*& le){
+  char* b = buf_.data();
+  for (;;){
+    size_t k = hi_;
+    while (k > lo_ && b[k - 1] != '\n') --k;
+    if (k > lo_){
+      const size_t end = hi_;
+      hi_ = k - 1;
+      if (skip_){ skip_ = false; continue; }
+      lb = b + k; le = b + end;
+      return true;
+    }
+    if (file_pos_ <= data_begin_){
+      if (lo_ < hi_ && !skip_){ lb = b + lo_; le = b + hi_; hi_ = lo_; return true; }
+      skip_ = false; hi_ = lo_;
+      return false;
+    }
+    // Refill: slide the partial line to the end, read the preceding block.
+    if (skip_) hi_ = lo_;
+    const size_t len = hi_ - lo_;
+    if (len == buf_.size()){
+      lb = b; le = b + len; lo_ = hi_ = buf_.size(); skip_ = true;
+      return true;
+    }
+    std::memmove(b + buf_.size() - len, b + lo_, len);
+    lo_ = buf_.size() - len; hi_ = buf_.size();
+    const size_t want = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(lo_),
+                                                              file_pos_ - data_begin_));
+    file_pos_ -= static_cast<int64_t>(want);
+    seek_to(f_, file_pos_);
+    const size_t n = std::fread(b + lo_ - want, 1, want, f_);
+    if (n != want){ file_pos_ = data_begin_; hi_ = lo_; return false; }
+    lo_ -= want;
+  }
+}
+
+bool BarStream::next_line(const char*& lb, const char*& le){
+  const bool ok = reverse_ ? rev_line(lb, le) : fwd_line(lb, le);
+  if (!ok) return false;
+  if (reverse_) --line_; else ++line_;
+  strip_cr(lb, le);
+  return true;
+}
+
+bool BarStream::next(Bar& b){
+  if (!f_) return false;
+  const char* lb = nullptr; const char* le = nullptr;
+  // The loader keeps the last warning in file order; read backwards, that
+  // is the first one seen.
+  auto warn = [&](const char* what){
+    if (!reverse_ || warn_.empty()) warn_ = what + std::to_string(line_);
+  };
+  while (next_line(lb, le)){
+    if (le == lb) continue;
+    if (const char* what = parse_csv_row(lb, le, schema_, b)){ warn(what); continue; }
+    if (schema_ == CsvSchema::TsMs){
+      if (b.ts_ms <= last_ts_) warn("Non-monotonic ts at ");
+      last_ts_ = b.ts_ms;
+    }
+    ++count_;
+    return true;
+  }
+  return false;
+}
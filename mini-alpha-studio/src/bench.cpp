@@ -0,0 +1,556 @@
+// Micro-benchmarks for the backtest/optimizer hot paths.
+//
+// Usage: mini_alpha_bench [--grid=fmin,fmax,smin,smax] [csv...]
+//        (defaults to the sample_data files and the GUI's 5..60 x 20..200 grid)
+#include "backtest_session.hpp"
+#include "dataset_registry.hpp"
+#include "indicator_cache.hpp"
+#include "monte_carlo.hpp"
+#include "optimize.hpp"
+#include "plot_lod.hpp"
+#include "result_store.hpp"
+#include "signal_kernels.hpp"
+#include "strategy.hpp"
+#include "sweep.hpp"
+#include "thread_pool.hpp"
+#include "walk_forward.hpp"
+#include "worker_procs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+// ---- Heap allocation counter (whole process) ----
+static std::atomic<size_t> g_allocs{0};
+
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic ignored "-Wmismatched-new-delete"   // malloc/free pairs below are consistent
+#endif
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+struct Timer {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+};
+
+struct Grid { int fmin = 5, fmax = 60, smin = 20, smax = 200; };
+
+template <class F>
+static void for_each_cell(const Grid& g, F&& f) {
+    for (int fa = g.fmin; fa <= g.fmax; ++fa)
+        for (int sl = std::max(g.smin, fa + 1); sl <= g.smax; ++sl) f(fa, sl);
+}
+
+// run_ma_crossover returning a fresh result vs. the reusable workspace.
+static void bench_workspace(const std::vector<SeriesPtr>& data, const Grid& g) {
+    double sink = 0.0;
+    size_t runs = 0;
+
+    size_t a0 = g_allocs.load();
+    Timer t_fresh;
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p; p.fast = f; p.slow = s;
+        for (auto& ds : data) { sink += run_ma_crossover(*ds, p).pnl; ++runs; }
+    });
+    const double ms_fresh = t_fresh.ms();
+    const size_t allocs_fresh = g_allocs.load() - a0;
+
+    BacktestWorkspace ws;
+    a0 = g_allocs.load();
+    Timer t_ws;
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p; p.fast = f; p.slow = s;
+        for (auto& ds : data) sink += run_ma_crossover(*ds, p, ws).pnl;
+    });
+    const double ms_ws = t_ws.ms();
+    const size_t allocs_ws = g_allocs.load() - a0;
+
+    std::printf("[workspace] %zu runs\n", runs);
+    std::printf("  fresh result : %9.1f ms  %10zu allocs\n", ms_fresh, allocs_fresh);
+    std::printf("  workspace    : %9.1f ms  %10zu allocs  (%.2fx)\n", ms_ws, allocs_ws,
+                ms_ws > 0 ? ms_fresh / ms_ws : 0.0);
+    if (sink == 1234.5) std::puts("");   // keep the loops alive
+}
+
+// Full result (curve + trades) vs. metrics-only scoring; also checks that
+// pnl/max_dd/trade count agree bit for bit.
+static void bench_stats(const std::vector<SeriesPtr>& data, const Grid& g) {
+    BacktestWorkspace ws;
+    double sink = 0.0;
+    size_t runs = 0, mismatches = 0;
+
+    Timer t_full;
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p; p.fast = f; p.slow = s;
+        for (auto& ds : data) { sink += run_ma_crossover(*ds, p, ws).pnl; ++runs; }
+    });
+    const double ms_full = t_full.ms();
+
+    Timer t_stats;
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p; p.fast = f; p.slow = s;
+        for (auto& ds : data) sink += run_ma_crossover_stats(*ds, p, ws).pnl;
+    });
+    const double ms_stats = t_stats.ms();
+
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p; p.fast = f; p.slow = s;
+        for (auto& ds : data) {
+            const BacktestStats st = run_ma_crossover_stats(*ds, p, ws);
+            const BacktestResult& r = run_ma_crossover(*ds, p, ws);
+            if (std::memcmp(&st.pnl, &r.pnl, sizeof(double)) != 0 ||
+                std::memcmp(&st.max_dd, &r.max_dd, sizeof(double)) != 0 ||
+                st.trades != r.trades.size() || st.bars != r.curve.size()) ++mismatches;
+        }
+    });
+
+    std::printf("[stats] %zu runs, %zu mismatches vs. full result\n", runs, mismatches);
+    std::printf("  full result  : %9.1f ms\n", ms_full);
+    std::printf("  stats only   : %9.1f ms  (%.2fx)\n", ms_stats, ms_stats > 0 ? ms_full / ms_stats : 0.0);
+    if (sink == 1234.5) std::puts("");
+}
+
+// Scoring every cell with its own SMA passes vs. grid_search_fast_slow,
+// which memoizes each window once per dataset (SmaCache).
+static void bench_grid(const std::vector<SeriesPtr>& data, const Grid& g) {
+    BacktestWorkspace ws;
+    MAParams base;
+    double best = -1e300; int bf = 0, bs = 0;
+
+    Timer t_naive;
+    for_each_cell(g, [&](int f, int s) {
+        MAParams p = base; p.fast = f; p.slow = s;
+        double total = 0.0;
+        for (auto& ds : data) {
+            const BacktestStats st = run_ma_crossover_stats(*ds, p, ws);
+            total += st.pnl / (1.0 + st.max_dd);
+        }
+        if (total / data.size() > best) { best = total / data.size(); bf = f; bs = s; }
+    });
+    const double ms_naive = t_naive.ms();
+
+    Timer t_grid;
+    const OptResult o = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax);
+    const double ms_grid = t_grid.ms();
+
+    std::printf("[grid] best %d/%d vs %d/%d (%s)\n", bf, bs, o.best_fast, o.best_slow,
+                (bf == o.best_fast && bs == o.best_slow && best == o.best_score) ? "same" : "DIFFERENT");
+    std::printf("  per-cell SMAs: %9.1f ms\n", ms_naive);
+    std::printf("  SMA memo     : %9.1f ms  (%.2fx)\n", ms_grid, ms_grid > 0 ? ms_naive / ms_grid : 0.0);
+}
+
+// Stats-only scoring with each crossover_scan variant the CPU supports, SMAs
+// taken from a warm SmaCache so only the signal scan and replay are timed.
+// Every variant must match the scalar one bit for bit.
+static void bench_simd(const std::vector<SeriesPtr>& data, const Grid& g) {
+    std::vector<std::unique_ptr<SmaCache>> caches;
+    for (auto& ds : data) caches.push_back(std::make_unique<SmaCache>(ds));
+    std::vector<double> sf, ss;
+    for_each_cell(g, [&](int f, int s) {
+        for (auto& c : caches) { c->get(f, sf); c->get(s, ss); }
+    });
+
+    auto run = [&](std::vector<BacktestStats>& out) {
+        out.clear();
+        for_each_cell(g, [&](int f, int s) {
+            MAParams p; p.fast = f; p.slow = s;
+            for (auto& c : caches) out.push_back(run_ma_crossover_stats(c->series(), c->get(f, sf), c->get(s, ss), p));
+        });
+    };
+
+    const SimdIsa saved = simd_isa();
+    const SimdIsa best  = simd_isa_supported();
+    std::vector<SimdIsa> isas = {SimdIsa::Scalar};
+    if (best == SimdIsa::Neon) isas.push_back(SimdIsa::Neon);
+    if (best == SimdIsa::Avx2 || best == SimdIsa::Avx512) isas.push_back(SimdIsa::Avx2);
+    if (best == SimdIsa::Avx512) isas.push_back(SimdIsa::Avx512);
+
+    std::vector<BacktestStats> ref, got;
+    std::printf("[simd] crossover_scan variants (best: %s)\n", simd_isa_name(best));
+    double ms_scalar = 0.0;
+    for (SimdIsa isa : isas) {
+        set_simd_isa(isa);
+        Timer t;
+        run(isa == SimdIsa::Scalar ? ref : got);
+        const double ms = t.ms();
+        if (isa == SimdIsa::Scalar) {
+            ms_scalar = ms;
+            std::printf("  %-12s : %9.1f ms\n", simd_isa_name(isa), ms);
+            continue;
+        }
+        size_t mismatches = 0;
+        for (size_t i = 0; i < ref.size(); ++i)
+            if (std::memcmp(&ref[i], &got[i], sizeof(BacktestStats)) != 0) ++mismatches;
+        std::printf("  %-12s : %9.1f ms  (%.2fx, %zu mismatches)\n", simd_isa_name(isa), ms,
+                    ms > 0 ? ms_scalar / ms : 0.0, mismatches);
+    }
+    set_simd_isa(saved);
+}
+
+// The grid search on 1, 2, 4, ... threads up to the shared pool's size; the
+// winner and its score must not change with the thread count.
+static void bench_parallel(const std::vector<SeriesPtr>& data, const Grid& g) {
+    MAParams base;
+    const unsigned hw = ThreadPool::shared().size() + 1;
+    std::printf("[parallel] grid search, shared pool %u workers + caller\n", hw - 1);
+
+    OptOptions o1; o1.threads = 1;
+    Timer t1;
+    const OptResult r1 = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax, o1);
+    const double ms1 = t1.ms();
+    std::printf("  %3u thread  : %9.1f ms  best %d/%d\n", 1u, ms1, r1.best_fast, r1.best_slow);
+
+    for (unsigned n = 2; n <= hw; n = (n * 2 > hw && n < hw) ? hw : n * 2) {
+        OptOptions on; on.threads = n;
+        Timer t;
+        const OptResult r = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax, on);
+        const double ms = t.ms();
+        const bool same = r.best_fast == r1.best_fast && r.best_slow == r1.best_slow &&
+                          std::memcmp(&r.best_score, &r1.best_score, sizeof(double)) == 0;
+        std::printf("  %3u threads : %9.1f ms  (%.2fx, %s)\n", n, ms, ms > 0 ? ms1 / ms : 0.0,
+                    same ? "same" : "DIFFERENT");
+    }
+}
+
+// The grid search fanned out to 2, 4, ... worker processes; the result must
+// match the in-process search.
+static void bench_processes(const std::vector<SeriesPtr>& data, const Grid& g) {
+    if (!worker_processes_supported()) { std::printf("[processes] not supported here\n"); return; }
+    MAParams base;
+    std::printf("[processes] grid search on forked workers\n");
+    Timer t0;
+    const OptResult ref = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax);
+    const double ms0 = t0.ms();
+    std::printf("  in-process   : %9.1f ms\n", ms0);
+    const unsigned hw = ThreadPool::shared().size() + 1;
+    for (unsigned n = 2; n <= std::max(4u, hw); n *= 2) {
+        OptOptions o; o.processes = n;
+        Timer t;
+        const OptResult r = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax, o);
+        const double ms = t.ms();
+        const bool same = r.best_fast == ref.best_fast && r.best_slow == ref.best_slow &&
+                          std::memcmp(&r.best_score, &ref.best_score, sizeof(double)) == 0;
+        std::printf("  %2u processes : %9.1f ms  (%.2fx, %s)\n", n, ms, ms > 0 ? ms0 / ms : 0.0,
+                    same ? "same" : "DIFFERENT");
+    }
+}
+
+// Each search strategy against the exhaustive grid: the pair it finds, how
+// far its score is from the grid optimum and how many backtests it ran.
+static void bench_strategies(const std::vector<SeriesPtr>& data, const Grid& g) {
+    MAParams base;
+    std::printf("[strategies] search strategies vs the full grid\n");
+    const SearchStrategy all[] = {SearchStrategy::Grid, SearchStrategy::CoarseToFine,
+                                  SearchStrategy::SuccessiveHalving, SearchStrategy::Random};
+    OptResult grid;
+    for (SearchStrategy st : all) {
+        OptOptions o; o.strategy = st;
+        Timer t;
+        const OptResult r = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax, o);
+        const double ms = t.ms();
+        if (st == SearchStrategy::Grid) grid = r;
+        std::printf("  %-18s : %9.1f ms  best %3d/%-3d score %10.4f (%6.2f%% of grid)  "
+                    "%8zu backtests (%6.1fx fewer)  %11zu bars\n",
+                    search_strategy_name(st), ms, r.best_fast, r.best_slow, r.best_score,
+                    grid.best_score != 0 ? 100.0 * r.best_score / grid.best_score : 0.0,
+                    r.evaluations, r.evaluations ? double(grid.evaluations) / r.evaluations : 0.0,
+                    r.bars_evaluated);
+    }
+}
+
+// A grid search against a fresh result store, the same search again (every
+// pair read back), then a grid widened by half in slow (only the new pairs
+// run). Results must match the storeless search.
+static void bench_store(const std::vector<SeriesPtr>& data, const Grid& g) {
+    MAParams base;
+    const std::string path = (std::filesystem::temp_directory_path() / "mini_alpha_bench.store").string();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    ResultStore store;
+    std::string err;
+    if (!store.open(path, err)) { std::printf("[store] skipped: %s\n", err.c_str()); return; }
+    std::printf("[store] grid search with a result store (%s)\n", path.c_str());
+
+    const OptResult ref = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax);
+    const int wide_smax = g.smax + (g.smax - g.smin) / 2;
+    const OptResult ref_wide = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, wide_smax);
+    auto run = [&](const char* what, int smax, const OptResult& want) {
+        OptOptions o; o.store = &store;
+        Timer t;
+        const OptResult r = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, smax, o);
+        const double ms = t.ms();
+        const bool same = r.best_fast == want.best_fast && r.best_slow == want.best_slow &&
+                          std::memcmp(&r.best_score, &want.best_score, sizeof(double)) == 0;
+        std::printf("  %-12s : %9.1f ms  %8zu run, %8zu from store  (%s)\n", what, ms,
+                    r.evaluations, r.store_hits, same ? "same" : "DIFFERENT");
+    };
+    run("cold", g.smax, ref);
+    run("warm", g.smax, ref);
+    run("widened", wide_smax, ref_wide);
+
+    ResultStore reopened;
+    if (reopened.open(path, err)) std::printf("  reopened     : %zu results on disk\n", reopened.size());
+    std::filesystem::remove(path, ec);
+}
+
+// The grid crossed with fee and slippage lists: one sweep (each pair's SMAs
+// and scan shared by its cost points) against one grid search per cost
+// setting. The sweep's best at each cost must match that grid search.
+static void bench_sweep(const std::vector<SeriesPtr>& data, const Grid& g) {
+    SweepSpec spec;
+    spec.fast         = SweepAxis<int>::range(g.fmin, g.fmax);
+    spec.slow         = SweepAxis<int>::range(g.smin, g.smax);
+    spec.fee_bps      = SweepAxis<float>::values({0.0f, 1.0f, 2.0f, 5.0f});
+    spec.slippage_bps = SweepAxis<float>::values({0.0f, 2.0f, 5.0f});
+    const size_t K = spec.fee_bps.size() * spec.slippage_bps.size();
+
+    // Best point per cost setting, collected through on_point.
+    std::vector<SweepPoint> best(K);
+    std::mutex mu;
+    SweepOptions so;
+    so.on_point = [&](const SweepPoint& pt) {
+        std::lock_guard<std::mutex> lk(mu);
+        SweepPoint& b = best[pt.index % K];
+        if (pt.score > b.score || (pt.score == b.score && pt.index < b.index)) b = pt;
+    };
+    Timer ts;
+    const SweepResult r = sweep_ma_crossover(data, spec, so);
+    const double ms_sweep = ts.ms();
+    std::printf("[sweep] %zu points (%zu scored), %zu signal passes, %zu pnl passes\n",
+                r.points, r.evaluated, r.signal_passes, r.pnl_passes);
+
+    Timer tg;
+    size_t mismatches = 0;
+    for (size_t k = 0; k < K; ++k) {
+        MAParams base;
+        base.fee_bps      = spec.fee_bps.at(k / spec.slippage_bps.size());
+        base.slippage_bps = spec.slippage_bps.at(k % spec.slippage_bps.size());
+        const OptResult o = grid_search_fast_slow(data, base, g.fmin, g.fmax, g.smin, g.smax);
+        if (o.best_fast != best[k].p.fast || o.best_slow != best[k].p.slow ||
+            std::memcmp(&o.best_score, &best[k].score, sizeof(double)) != 0) ++mismatches;
+    }
+    const double ms_grids = tg.ms();
+    std::printf("  sweep        : %9.1f ms  best %d/%d fee %.1f slip %.1f score %.4f\n", ms_sweep,
+                r.top.empty() ? 0 : r.top[0].p.fast, r.top.empty() ? 0 : r.top[0].p.slow,
+                r.top.empty() ? 0.0 : r.top[0].p.fee_bps, r.top.empty() ? 0.0 : r.top[0].p.slippage_bps,
+                r.top.empty() ? 0.0 : r.top[0].score);
+    std::printf("  %2zu grids     : %9.1f ms  (%.2fx, %zu mismatches)\n", K, ms_grids,
+                ms_sweep > 0 ? ms_grids / ms_sweep : 0.0, mismatches);
+}
+
+// Rolling walk-forward (3y train / 6m test) with the folds sharing one SMA
+// memo per series, against the same folds each searched with a fresh memo.
+// Both must pick the same pairs.
+static void bench_walkforward(const std::vector<SeriesPtr>& data, const Grid& g) {
+    MAParams base;
+    WalkForwardSpec spec;
+    Timer tw;
+    const WalkForwardResult r = walk_forward(data, base, g.fmin, g.fmax, g.smin, g.smax, spec);
+    const double ms_wf = tw.ms();
+    std::printf("[walkforward] %zu folds (train %zu, test %zu bars), OOS score %.4f, OOS pnl %.2f\n",
+                r.folds, spec.train_bars, spec.test_bars, r.oos_score, r.oos_pnl);
+
+    Timer tf;
+    size_t mismatches = 0, s = 0;
+    for (auto& ds : data) {
+        if (ds->size() <= spec.train_bars) continue;
+        for (const WalkForwardFold& f : r.series[s].folds) {
+            OptOptions o; o.top_k = 1; o.bar_begin = f.train_begin; o.bar_end = f.train_end;
+            const OptResult fr = grid_search_fast_slow({std::make_shared<SmaCache>(ds)}, base,
+                                                       g.fmin, g.fmax, g.smin, g.smax, o);
+            if (fr.best_fast != f.fast || fr.best_slow != f.slow) ++mismatches;
+        }
+        ++s;
+    }
+    const double ms_fresh = tf.ms();
+    std::printf("  shared SMAs  : %9.1f ms  %8zu backtests\n", ms_wf, r.evaluations);
+    std::printf("  fresh/fold   : %9.1f ms  (%.2fx, %zu mismatches)\n", ms_fresh,
+                ms_wf > 0 ? ms_fresh / ms_wf : 0.0, mismatches);
+}
+
+// 100k scenarios of each robustness kind per dataset, on the pool and on
+// one thread. The two must agree exactly.
+static void bench_montecarlo(const std::vector<SeriesPtr>& data, const Grid&) {
+    MAParams p;
+    RobustnessSpec spec;
+    spec.scenarios = 100000;
+    std::printf("[montecarlo] %zu scenarios x 3 kinds per dataset (fast %d, slow %d)\n",
+                spec.scenarios, p.fast, p.slow);
+    for (const SeriesPtr& ds : data) {
+        BacktestWorkspace ws;
+        const BacktestResult& r = run_ma_crossover(*ds, p, ws);
+        Timer tp;
+        const RobustnessResult a = robustness_analysis(r, p, spec);
+        const double ms_pool = tp.ms();
+        RobustnessOptions one; one.threads = 1;
+        Timer t1;
+        const RobustnessResult b = robustness_analysis(r, p, spec, one);
+        const double ms_one = t1.ms();
+        const bool same = a.bootstrap.pnl == b.bootstrap.pnl && a.shuffle.max_dd == b.shuffle.max_dd &&
+                          a.costs.pnl == b.costs.pnl;
+        std::printf("  %6zu bars %3zu trips : pool %7.1f ms, 1 thread %7.1f ms (%s)  "
+                    "pnl %.2f  boot p5/p50/p95 %.2f/%.2f/%.2f  shuffle dd p95 %.2f  costs p5 %.2f\n",
+                    r.curve.size(), a.trips, ms_pool, ms_one, same ? "same" : "DIFFERENT", a.base_pnl,
+                    a.bootstrap.pnl_quantile(0.05), a.bootstrap.pnl_quantile(0.5), a.bootstrap.pnl_quantile(0.95),
+                    a.shuffle.dd_quantile(0.95), a.costs.pnl_quantile(0.05));
+    }
+}
+
+// Slider drags on a ~2M-bar series (the first dataset tiled): fee steps
+// replay the known trades, fast steps hit the SMA memo on the way back.
+// Every update must match a fresh run_ma_crossover.
+static void bench_session(const std::vector<SeriesPtr>& data, const Grid&) {
+    auto big = std::make_shared<BarSeries>();
+    while (big->size() < 2000000) big->append(*data[0]);
+    BacktestSession session(big);
+    MAParams p;
+    session.update(p);
+    std::printf("[session] %zu bars\n", big->size());
+
+    size_t mismatches = 0;
+    auto check = [&](const BacktestResult& r) {
+        const BacktestResult ref = run_ma_crossover(*big, session.params());
+        if (std::memcmp(&r.pnl, &ref.pnl, sizeof(double)) != 0 || r.trades.size() != ref.trades.size() ||
+            r.curve.size() != ref.curve.size() ||
+            std::memcmp(&r.curve.back().equity, &ref.curve.back().equity, sizeof(double)) != 0) ++mismatches;
+    };
+    auto drag = [&](const char* what, int steps, auto&& set) {
+        Timer t;
+        for (int i = 0; i < steps; ++i) { set(p, i); session.update(p); }
+        std::printf("  %-14s : %7.2f ms per update\n", what, t.ms() / steps);
+        check(session.result());
+    };
+    drag("fee drag", 50, [](MAParams& q, int i) { q.fee_bps = 0.1f * float(i); });
+    drag("fast drag", 20, [](MAParams& q, int i) { q.fast = 5 + i; });
+    drag("fast drag back", 20, [](MAParams& q, int i) { q.fast = 24 - i; });
+
+    Timer t;
+    for (int i = 0; i < 5; ++i) { p.fee_bps = 0.5f * float(i); (void)run_ma_crossover(*big, p); }
+    std::printf("  %-14s : %7.2f ms per update  (%zu mismatches)\n", "full rerun", t.ms() / 5, mismatches);
+}
+
+// Plot pyramids for a ~2M-point equity curve: build once, then one frame's
+// worth of queries at 1920 px (a min/max per column plus a trace). The
+// column extremes must match a brute-force scan.
+static void bench_lod(const std::vector<SeriesPtr>& data, const Grid&) {
+    BarSeries big;
+    while (big.size() < 2000000) big.append(*data[0]);
+    for (size_t i = 0; i < big.size(); ++i) big.ts_ms[i] = int64_t(i) * 60000;   // ascending, as loaded series are
+    const BacktestResult r = run_ma_crossover(big, MAParams{});
+    const size_t n = r.curve.size(), cols = 1920;
+
+    SeriesLod lod;
+    Timer tb;
+    lod.build(r.curve, &BacktestPoint::equity);
+    const double ms_build = tb.ms();
+
+    Timer tf;
+    float sink = 0.0f;
+    for (size_t c = 0; c < cols; ++c) {
+        const auto mm = lod.minmax(c * n / cols, (c + 1) * n / cols);
+        sink += mm.second - mm.first;
+    }
+    const std::vector<uint32_t>& trace = lod.trace(cols);
+    const double us_frame = tf.ms() * 1e3;
+
+    size_t mismatches = 0;
+    for (size_t c = 0; c < cols; ++c) {
+        const size_t a = c * n / cols, b = (c + 1) * n / cols;
+        float lo = float(r.curve[a].equity), hi = lo;
+        for (size_t i = a; i < b; ++i) { lo = std::min(lo, float(r.curve[i].equity)); hi = std::max(hi, float(r.curve[i].equity)); }
+        const auto mm = lod.minmax(a, b);
+        if (mm.first != lo || mm.second != hi) ++mismatches;
+    }
+    std::printf("[lod] %zu points: build %.1f ms, frame at %zu px %.1f us (%zu columns + %zu trace points, "
+                "%zu mismatches)%s\n", n, ms_build, cols, us_frame, cols, trace.size(), mismatches,
+                sink < 0 ? "" : "");
+
+    // Zoomed views, centred, from the whole curve down to 1000 points: the
+    // visible trace plus the trades on screen, both found by binary search.
+    std::vector<uint32_t> idx;
+    for (size_t span = n; span >= 1000; span /= 10) {
+        const size_t a = (n - span) / 2, b = a + span;
+        Timer tz;
+        lod.trace(a, b, cols, idx);
+        const auto vis = trades_between(r.trades, series_index_at(big, r.curve[a].ts_ms),
+                                        series_index_at(big, r.curve[b - 1].ts_ms) + 1);
+        const double us = tz.ms() * 1e3;
+        const bool covers = !idx.empty() && idx.front() <= a && idx.back() + 1 >= b;
+        std::printf("[lod] zoom %zu of %zu: %.1f us, %zu trace points, %zu trades%s\n", span, n, us, idx.size(),
+                    vis.second - vis.first, covers ? "" : " (MISSES EDGES)");
+    }
+
+    // Trade markers of the whole view: clusters per pixel column and side
+    // against one marker per trade; repeated frames hit the cache.
+    TradeClusters markers;
+    Timer tc;
+    const size_t clusters = markers.update(0, big, r.curve, r.trades, 0.0, double(n), cols).size();
+    const double us_cluster = tc.ms() * 1e3;
+    Timer th;
+    for (int i = 0; i < 100; ++i) markers.update(0, big, r.curve, r.trades, 0.0, double(n), cols);
+    std::printf("[lod] trade markers at %zu px: %zu trades -> %zu clusters in %.1f us, cached frame %.3f us (%zu builds)\n",
+                cols, r.trades.size(), clusters, us_cluster, th.ms() * 10.0, markers.builds());
+}
+
+int main(int argc, char** argv) {
+    Grid g;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a.rfind("--grid=", 0) == 0) {
+            if (std::sscanf(a.c_str() + 7, "%d,%d,%d,%d", &g.fmin, &g.fmax, &g.smin, &g.smax) != 4) {
+                std::fprintf(stderr, "bad %s\n", a.c_str());
+                return 2;
+            }
+        } else paths.push_back(a);
+    }
+    if (paths.empty())
+        paths = {"sample_data/TSLA_5Y.csv", "sample_data/MSFT_5Y.csv",
+                 "sample_data/NVDA_5Y.csv", "sample_data/AAPL_5Y.csv"};
+
+    std::vector<SeriesPtr> data;
+    size_t bars = 0;
+    for (auto& d : DatasetRegistry::instance().get_many(paths)) {
+        if (!d.err.empty()) { std::fprintf(stderr, "%s: %s\n", d.path.c_str(), d.err.c_str()); continue; }
+        bars += d.series->size();
+        data.push_back(d.series);
+    }
+    if (data.empty()) return 1;
+    std::printf("%zu datasets, %zu bars\n", data.size(), bars);
+
+    bench_workspace(data, g);
+    bench_stats(data, g);
+    bench_grid(data, g);
+    bench_simd(data, g);
+    bench_parallel(data, g);
+    bench_processes(data, g);
+    bench_strategies(data, g);
+    bench_store(data, g);
+    bench_sweep(data, g);
+    bench_walkforward(data, g);
+    bench_montecarlo(data, g);
+    bench_session(data, g);
+    bench_lod(data, g);
+    return 0;
+}
@@ -1,166 +1,336 @@
 #include "csv.hpp"
-#include <fstream>
-#include <sstream>
+#include "bar_cache.hpp"
+#include "csv_row.hpp"
+#include "mapped_file.hpp"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
 
-#if defined(_WIN32)
-  #include <time.h>
-  static inline time_t timegm_portable(std::tm* t){ return _mkgmtime(t); }
-#else
-  static inline time_t timegm_portable(std::tm* t){ return timegm(t); }
-#endif
+// The loader walks the mapped file in place: no per-line strings, no
+// istringstream, no exceptions. Numbers go through std::from_chars.
 
-static inline void trim_cr(std::string& s){
-  if (!s.empty() && (s.back() == '\r' || s.back()=='\n')) s.pop_back();
+static inline bool is_blank(char c){ return c == ' ' || c == '\t'; }
+
+static inline void trim(const char*& b, const char*& e){
+  while (b < e && is_blank(*b)) ++b;
+  while (e > b && (is_blank(e[-1]) || e[-1] == '\r' || e[-1] == '\n')) --e;
 }
 
-static inline std::string strip_chars(std::string s, const char* chars){
-  for (const char* c = chars; *c; ++c){
-    s.erase(std::remove(s.begin(), s.end(), *c), s.end());
+// Next comma-separated field of [p, end). A field wrapped in double quotes may
+// contain commas (vendor exports quote "168,156,400"). Advances p past the
+// delimiter. Returns false when the line has no more fields.
+static inline bool next_field(const char*& p, const char* end, const char*& fb, const char*& fe){
+  if (!p || p > end) return false;
+  const char* q = p;
+  while (q < end && is_blank(*q)) ++q;
+  if (q < end && *q == '"'){
+    const char* close = static_cast<const char*>(std::memchr(q + 1, '"', static_cast<size_t>(end - q - 1)));
+    if (!close) return false;
+    fb = q + 1; fe = close;
+    const char* c = static_cast<const char*>(std::memchr(close, ',', static_cast<size_t>(end - close)));
+    p = c ? c + 1 : nullptr;
+    return true;
   }
-  return s;
+  const char* c = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+  fb = p; fe = c ? c : end;
+  p = c ? c + 1 : nullptr;
+  return true;
+}
+
+static inline bool parse_i64(const char* b, const char* e, int64_t& v){
+  trim(b, e);
+  if (b < e && *b == '+') ++b;
+  auto r = std::from_chars(b, e, v);
+  return r.ec == std::errc() && r.ptr == e && b < e;
 }
 
-static inline bool split6(const std::string& line, std::string out[6]){
-  std::istringstream ss(line);
-  for (int i=0;i<6;i++){
-    if(!std::getline(ss, out[i], ',')) return false;
+static inline bool parse_f64(const char* b, const char* e, double& v){
+  trim(b, e);
+  if (b < e && *b == '+') ++b;
+  auto r = std::from_chars(b, e, v);
+  return r.ec == std::errc() && r.ptr == e && b < e;
+}
+
+// "$1,234.50" / " 168,156,400 " -> double. Copies the significant characters
+// into a stack buffer, dropping '$', thousands separators and blanks.
+static inline bool parse_money(const char* b, const char* e, double& v){
+  char buf[64]; size_t n = 0;
+  for (const char* c = b; c < e; ++c){
+    if (*c == '$' || *c == ',' || is_blank(*c) || *c == '\r' || *c == '\n') continue;
+    if (n == sizeof(buf)) return false;
+    buf[n++] = *c;
   }
-  return true;
+  if (n == 0) return false;
+  auto r = std::from_chars(buf, buf + n, v);
+  return r.ec == std::errc() && r.ptr == buf + n;
 }
 
-// Parse "MM/DD/YYYY" -> epoch ms at 00:00:00 UTC
-static inline int64_t parse_date_ms(const std::string& mmddyyyy){
-  int m=0,d=0,y=0;
-  // Be tolerant of leading/trailing spaces
-  std::string s = mmddyyyy;
-  // manual parse
-  char c1='/', c2='/';
-  std::istringstream is(s);
-  is >> m >> c1 >> d >> c2 >> y;
-  if (!is || c1!='/' || c2!='/') return -1;
-
-  std::tm tm{}; tm.tm_year = y - 1900; tm.tm_mon = m - 1; tm.tm_mday = d;
-  tm.tm_hour = 0; tm.tm_min = 0; tm.tm_sec = 0;
-  time_t t = timegm_portable(&tm);
-  if (t < 0) return -1;
-  return static_cast<int64_t>(t) * 1000;
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm).
+static constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d){
+  y -= m <= 2;
+  const int64_t  era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
 }
 
-std::vector<Bar> load_csv(const std::string& path, std::string& warn, std::string& err){
-  std::vector<Bar> out;
-  warn.clear(); err.clear();
+static inline unsigned days_in_month(int y, unsigned m){
+  static const unsigned dim[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
+  const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+  return (m == 2 && leap) ? 29 : dim[m - 1];
+}
 
-  std::ifstream f(path);
-  if(!f){ err = "Cannot open " + path; return out; }
+// Parse "MM/DD/YYYY" -> epoch ms at 00:00:00 UTC, or -1
+static inline int64_t parse_date_ms(const char* b, const char* e){
+  trim(b, e);
+  unsigned m = 0, d = 0; int y = 0;
+  auto r = std::from_chars(b, e, m);
+  if (r.ec != std::errc() || r.ptr == e || *r.ptr != '/') return -1;
+  r = std::from_chars(r.ptr + 1, e, d);
+  if (r.ec != std::errc() || r.ptr == e || *r.ptr != '/') return -1;
+  r = std::from_chars(r.ptr + 1, e, y);
+  if (r.ec != std::errc() || r.ptr != e) return -1;
+  if (m < 1 || m > 12 || d < 1 || d > days_in_month(y, m)) return -1;
+  const int64_t days = days_from_civil(y, m, d);
+  if (days < 0) return -1;
+  return days * 86400LL * 1000LL;
+}
 
-  std::string header;
-  if (!std::getline(f, header)){ err = "Empty file"; return out; }
-  trim_cr(header);
+// ---- Row parsing (shared with BarStream, see csv_row.hpp) ----
 
+CsvSchema detect_csv_schema(const std::string& header){
   // Normalize header for detection (remove spaces, lower-case)
-  auto norm = [](std::string s){
-    s.erase(std::remove_if(s.begin(), s.end(), ::isspace), s.end());
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return std::tolower(c); });
-    return s;
-  };
-  std::string H = norm(header);
+  std::string H = header;
+  H.erase(std::remove_if(H.begin(), H.end(), ::isspace), H.end());
+  std::transform(H.begin(), H.end(), H.begin(), [](unsigned char c){ return std::tolower(c); });
+
+  if (H.find("ts_ms") != std::string::npos && H.find("open") != std::string::npos)
+    return CsvSchema::TsMs;
+  if (H.find("date") != std::string::npos && H.find("close/last") != std::string::npos)
+    return CsvSchema::DateCloseLast;
+  return CsvSchema::Unknown;
+}
+
+const char* parse_csv_row(const char* lb, const char* le, CsvSchema schema, Bar& b){
+  const char* cur = lb;
+  const char* fb = nullptr; const char* fe = nullptr;
+  b = Bar{};
+
+  if (schema == CsvSchema::TsMs){
+    // ---- ORIGINAL SCHEMA: ts_ms,open,high,low,close,volume ----
+    if (!next_field(cur, le, fb, fe)) return "Malformed line ";
+    if (!parse_i64(fb, fe, b.ts_ms))  return "Parse error at ";
+
+    for (double* d : {&b.open, &b.high, &b.low, &b.close, &b.volume}){
+      if (!next_field(cur, le, fb, fe)) return "Bad numeric at ";
+      if (!parse_f64(fb, fe, *d))       return "Parse error at ";
+    }
+    return nullptr;
+  }
+
+  // ---- NEW SCHEMA: Date,Close/Last,Volume,Open,High,Low ----
+  // Example:
+  // 09/12/2025,$395.94,168156400,$370.94,$396.6899,$370.24
+  // ($ signs and thousands separators are skipped while parsing)
+  const char* fbs[6]; const char* fes[6];
+  int nf = 0;
+  while (nf < 6 && next_field(cur, le, fbs[nf], fes[nf])) ++nf;
+  if (nf < 6) return "Malformed line ";
+
+  // Date -> ts_ms
+  b.ts_ms = parse_date_ms(fbs[0], fes[0]);
+  if (b.ts_ms < 0) return "Bad date at line ";
+
+  // volume can be very big; store as double
+  if (!parse_money(fbs[1], fes[1], b.close) || !parse_money(fbs[2], fes[2], b.volume) ||
+      !parse_money(fbs[3], fes[3], b.open)  || !parse_money(fbs[4], fes[4], b.high)   ||
+      !parse_money(fbs[5], fes[5], b.low)){
+    return "Numeric parse error at line ";
+  }
+  return nullptr;
+}
+
+// ---- Chunked parsing ----
+// The data region is split into newline-aligned chunks that are parsed
+// independently. Warnings are recorded with chunk-local line numbers and only
+// formatted once every chunk's line count is known.
+
+namespace {
+
+struct ParseWarn {
+  const char* what = nullptr;   // message prefix, e.g. "Malformed line "
+  size_t      line = 0;         // 1-based line within the chunk
+};
+
+struct ChunkOut {
+  BarSeries bars;
+  size_t    lines = 0;          // lines consumed by this chunk
+  size_t    first_bar_line = 0; // chunk-local line of bars.front()
+  ParseWarn warn;               // last warning raised inside the chunk
+};
+
+constexpr size_t kMinChunkBytes = size_t(8) << 20;  // below this, threads cost more than they save
+
+} // namespace
+
+// check_first: compare the first bar against last = -1 like a whole-file pass.
+// Later chunks leave that comparison to the stitcher.
+static void parse_chunk(const char* p, const char* end, CsvSchema schema, bool check_first,
+                        ChunkOut& out){
+  // Rough row estimate from the first line avoids regrowth on big files.
+  {
+    const char* l2 = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (l2 && l2 > p) out.bars.reserve(static_cast<size_t>(end - p) / static_cast<size_t>(l2 - p + 1) + 16);
+  }
 
-  const bool schema_ts_ms =
-      H.find("ts_ms") != std::string::npos && H.find("open") != std::string::npos;
-  const bool schema_date_close_last =
-      H.find("date") != std::string::npos && H.find("close/last") != std::string::npos;
+  size_t ln = 0;
+  int64_t last = -1;
+  bool have_last = check_first;
+  auto warn = [&](const char* what){ out.warn = ParseWarn{what, ln}; };
 
-  if (!schema_ts_ms && !schema_date_close_last){
+  while (p < end){
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char* le = nl ? nl : end;
+    const char* lb = p;
+    p = nl ? nl + 1 : end;
+    ++ln;
+    if (le > lb && le[-1] == '\r') --le;
+    if (le == lb) continue;
+
+    Bar b;
+    if (const char* what = parse_csv_row(lb, le, schema, b)){ warn(what); continue; }
+    if (schema == CsvSchema::TsMs){
+      if (have_last && b.ts_ms <= last) warn("Non-monotonic ts at ");
+      last = b.ts_ms; have_last = true;
+    }
+
+    if (out.bars.empty()) out.first_bar_line = ln;
+    out.bars.push_back(b);
+  }
+  out.lines = ln;
+}
+
+static BarSeries parse_csv_text(const std::string& path, std::string& warn, std::string& err,
+                                CsvLoadStats* stats){
+  BarSeries out;
+
+  MappedFile mf;
+  if (!mf.open(path, err)) return out;
+
+  const char* p   = mf.data();
+  const char* end = p + mf.size();
+  if (p == end){ err = "Empty file"; return out; }
+
+  const char* nl = static_cast<const char*>(std::memchr(p, '\n', mf.size()));
+  const char* he = nl ? nl : end;
+  if (he > p && he[-1] == '\r') --he;
+  std::string header(p, he);
+  p = nl ? nl + 1 : end;
+
+  const CsvSchema schema = detect_csv_schema(header);
+  if (schema == CsvSchema::Unknown){
     err = "Unrecognized header: " + header;
     return out;
   }
 
-  std::string line; size_t ln = 1; // already read header
+  // ---- Split into newline-aligned chunks ----
+  const size_t body = static_cast<size_t>(end - p);
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  const size_t n_chunks = std::max<size_t>(1, std::min<size_t>(hw, body / kMinChunkBytes));
 
-  if (schema_ts_ms){
-    // ---- ORIGINAL SCHEMA: ts_ms,open,high,low,close,volume ----
-    int64_t last=-1;
-    while (std::getline(f, line)){
-      ++ln; trim_cr(line);
-      if(line.empty()) continue;
-
-      std::istringstream ss(line); std::string tok; Bar b{};
-      if(!std::getline(ss,tok,',')) { warn = "Malformed line " + std::to_string(ln); continue; }
-
-      try {
-        b.ts_ms = std::stoll(tok);
-        auto rd=[&](double& d){
-          if(!std::getline(ss,tok,',')) return false;
-          d = std::stod(tok); return true;
-        };
-        if(!rd(b.open)||!rd(b.high)||!rd(b.low)||!rd(b.close)||!rd(b.volume)){
-          warn = "Bad numeric at " + std::to_string(ln); continue;
-        }
-      } catch(...){
-        warn = "Parse error at " + std::to_string(ln); continue;
-      }
-
-      if (b.ts_ms <= last) warn = "Non-monotonic ts at " + std::to_string(ln);
-      last = b.ts_ms;
-      out.push_back(b);
-    }
+  std::vector<const char*> cuts{p};
+  for (size_t k = 1; k < n_chunks; ++k){
+    const char* t = std::max(cuts.back(), p + body / n_chunks * k);
+    const char* c = static_cast<const char*>(std::memchr(t, '\n', static_cast<size_t>(end - t)));
+    if (!c) break;
+    if (c + 1 > cuts.back()) cuts.push_back(c + 1);
+  }
+  cuts.push_back(end);
+
+  std::vector<ChunkOut> chunks(cuts.size() - 1);
+  if (chunks.size() == 1){
+    parse_chunk(cuts[0], cuts[1], schema, true, chunks[0]);
   } else {
-    // ---- NEW SCHEMA: Date,Close/Last,Volume,Open,High,Low ----
-    // Example:
-    // 09/12/2025,$395.94,168,156,400, $370.94, $396.6899, $370.24
-    // (commas and $ signs must be stripped)
-    std::vector<Bar> tmp;
-    while (std::getline(f, line)){
-      ++ln; trim_cr(line);
-      if(line.empty()) continue;
-
-      std::string cols[6];
-      if (!split6(line, cols)){ warn = "Malformed line " + std::to_string(ln); continue; }
-
-      Bar b{};
-      // Date -> ts_ms
-      b.ts_ms = parse_date_ms(cols[0]);
-      if (b.ts_ms < 0){ warn = "Bad date at line " + std::to_string(ln); continue; }
-
-      // Helpers to clean money/commas
-      auto money = [](std::string s)->double{
-        s = strip_chars(s, "$ \t");
-        // some providers add '\r'
-        if (!s.empty() && (s.back()=='\r' || s.back()=='\n')) s.pop_back();
-        return std::stod(s);
-      };
-      auto number_commas = [](std::string s)->double{
-        s = strip_chars(s, ", \t");
-        if (!s.empty() && (s.back()=='\r' || s.back()=='\n')) s.pop_back();
-        return std::stod(s);
-      };
-
-      try{
-        double close = money(cols[1]);
-        double vol   = number_commas(cols[2]);  // volume can be very big; store as double
-        double open  = money(cols[3]);
-        double high  = money(cols[4]);
-        double low   = money(cols[5]);
-
-        b.open = open; b.high = high; b.low = low; b.close = close; b.volume = vol;
-      } catch(...){
-        warn = "Numeric parse error at line " + std::to_string(ln); continue;
-      }
-
-      tmp.push_back(b);
-    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    for (size_t k = 0; k < chunks.size(); ++k)
+      workers.emplace_back(parse_chunk, cuts[k], cuts[k + 1], schema, k == 0, std::ref(chunks[k]));
+    for (auto& t : workers) t.join();
+  }
+  if (stats) stats->threads = static_cast<unsigned>(chunks.size());
 
-    if (tmp.empty()) return out;
+  // ---- Stitch in order ----
+  // The first bar of each later chunk is checked against the last bar before
+  // it; the reported warning is the one on the highest line, as in one pass.
+  size_t total = 0;
+  for (auto& c : chunks) total += c.bars.size();
+  if (chunks.size() > 1) out.reserve(total);
 
-    // Many vendor files are newest-first. Ensure ascending time.
-    if (tmp.size() >= 2 && tmp.front().ts_ms > tmp.back().ts_ms){
-      std::reverse(tmp.begin(), tmp.end());
+  size_t line_base = 1;  // header
+  const char* last_what = nullptr; size_t last_line = 0;
+  bool have_prev = false; int64_t prev_ts = 0;
+  for (size_t k = 0; k < chunks.size(); ++k){
+    ChunkOut& c = chunks[k];
+    ParseWarn w = c.warn;
+    if (schema == CsvSchema::TsMs && k > 0 && have_prev && !c.bars.empty() && c.bars.ts_ms.front() <= prev_ts &&
+        (!w.what || w.line < c.first_bar_line)){
+      w = ParseWarn{"Non-monotonic ts at ", c.first_bar_line};
     }
-    out.swap(tmp);
+    if (w.what){ last_what = w.what; last_line = line_base + w.line; }
+    if (!c.bars.empty()){ have_prev = true; prev_ts = c.bars.ts_ms.back(); }
+    line_base += c.lines;
+
+    if (chunks.size() > 1){ out.append(c.bars); c.bars = BarSeries{}; }
+  }
+  if (chunks.size() == 1) out = std::move(chunks[0].bars);
+  if (last_what) warn = last_what + std::to_string(last_line);
+
+  // Many vendor files are newest-first. Ensure ascending time.
+  if (schema == CsvSchema::DateCloseLast && out.size() >= 2 && out.ts_ms.front() > out.ts_ms.back()){
+    out.reverse();
   }
 
   return out;
-}
\ No newline at end of file
+}
+
+static bool bar_cache_enabled(){
+  const char* v = std::getenv("MINI_ALPHA_BAR_CACHE");
+  return !(v && v[0] == '0');
+}
+
+BarSeries load_bar_series(const std::string& path, std::string& warn, std::string& err,
+                          CsvLoadStats* stats){
+  BarSeries out;
+  warn.clear(); err.clear();
+
+  const auto t0 = std::chrono::steady_clock::now();
+  auto finish = [&](bool from_cache){
+    if (!stats) return;
+    std::error_code ec;
+    const auto sz = std::filesystem::file_size(from_cache ? bar_cache_path(path) : path, ec);
+    stats->bytes      = ec ? 0 : static_cast<size_t>(sz);
+    stats->seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    stats->from_cache = from_cache;
+  };
+  if (stats){ *stats = CsvLoadStats{}; }
+
+  const bool use_cache = bar_cache_enabled();
+  if (use_cache && read_bar_cache(path, out, warn)){ finish(true); return out; }
+
+  out = parse_csv_text(path, warn, err, stats);
+  finish(false);
+  if (use_cache && err.empty()) write_bar_cache(path, out, warn);
+  return out;
+}
+
+std::vector<Bar> load_csv(const std::string& path, std::string& warn, std::string& err,
+                          CsvLoadStats* stats){
+  return load_bar_series(path, warn, err, stats).to_bars();
+}
@@ -0,0 +1,142 @@
+#include "dataset_registry.hpp"
+#include "thread_pool.hpp"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// "<canonical>|<size>|<mtime>", or empty when the file can't be stat'ed.
+static std::string dataset_key(const std::string& path, std::string& canonical){
+    std::error_code ec;
+    canonical = fs::canonical(path, ec).string();
+    if (ec) return {};
+    const auto size = fs::file_size(canonical, ec);
+    if (ec) return {};
+    const auto mtime = fs::last_write_time(canonical, ec);
+    if (ec) return {};
+    return canonical + "|" + std::to_string(size) + "|" +
+           std::to_string(static_cast<long long>(mtime.time_since_epoch().count()));
+}
+
+static Dataset load_dataset(const std::string& path){
+    Dataset d;
+    d.path = path;
+    auto s = std::make_shared<BarSeries>(load_bar_series(path, d.warn, d.err, &d.stats));
+    if (d.err.empty()) d.series = std::move(s);
+    return d;
+}
+
+DatasetRegistry::DatasetRegistry(size_t budget_bytes) : budget_(budget_bytes) {}
+
+DatasetRegistry& DatasetRegistry::instance(){
+    static DatasetRegistry reg;
+    return reg;
+}
+
+Dataset DatasetRegistry::get(const std::string& path){
+    std::string canonical;
+    const std::string key = dataset_key(path, canonical);
+    if (key.empty()) return load_dataset(path);   // missing file: let the loader report it
+
+    std::promise<Dataset> promise;
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()){
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            Dataset d = it->second.data;
+            d.path = path;
+            return d;
+        }
+        auto fl = inflight_.find(key);
+        if (fl != inflight_.end()){
+            auto fut = fl->second;
+            lk.unlock();
+            Dataset d = fut.get();
+            d.path = path;
+            return d;
+        }
+        ++misses_;
+        inflight_.emplace(key, promise.get_future().share());
+    }
+
+    // A throwing load (e.g. bad_alloc) must still release the inflight
+    // entry, or this key would rethrow for every later caller, and pass the
+    // exception on to the callers waiting on it.
+    Dataset d;
+    try {
+        d = load_dataset(path);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            inflight_.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (d.series){
+            Entry e;
+            e.canonical = canonical;
+            e.data  = d;
+            e.bytes = d.series->bytes();
+            insert_locked(key, std::move(e));
+        }
+        inflight_.erase(key);
+    }
+    promise.set_value(d);
+    return d;
+}
+
+std::vector<Dataset> DatasetRegistry::get_many(const std::vector<std::string>& paths){
+    // parallel_for has the caller run loads too, so this can't wait forever
+    // on pool workers that are all busy (or are the caller itself).
+    std::vector<Dataset> out(paths.size());
+    ThreadPool::shared().parallel_for(paths.size(), [&](size_t i){ out[i] = get(paths[i]); });
+    return out;
+}
+
+void DatasetRegistry::insert_locked(const std::string& key, Entry e){
+    // A newer version of the same file supersedes any older one.
+    for (auto it = entries_.begin(); it != entries_.end();){
+        if (it->second.canonical == e.canonical){
+            used_ -= it->second.bytes;
+            lru_.erase(it->second.lru);
+            it = entries_.erase(it);
+        } else ++it;
+    }
+    lru_.push_front(key);
+    e.lru = lru_.begin();
+    used_ += e.bytes;
+    entries_[key] = std::move(e);
+    evict_locked();
+}
+
+void DatasetRegistry::evict_locked(){
+    // Keep at least the newest entry even if it alone exceeds the budget.
+    while (used_ > budget_ && lru_.size() > 1){
+        auto it = entries_.find(lru_.back());
+        used_ -= it->second.bytes;
+        entries_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void DatasetRegistry::set_budget(size_t bytes){
+    std::lock_guard<std::mutex> lk(mu_);
+    budget_ = bytes;
+    evict_locked();
+}
+
+size_t DatasetRegistry::budget()       const { std::lock_guard<std::mutex> lk(mu_); return budget_; }
+size_t DatasetRegistry::bytes_in_use() const { std::lock_guard<std::mutex> lk(mu_); return used_; }
+size_t DatasetRegistry::hits()         const { std::lock_guard<std::mutex> lk(mu_); return hits_; }
+size_t DatasetRegistry::misses()       const { std::lock_guard<std::mutex> lk(mu_); return misses_; }
+
+void DatasetRegistry::clear(){
+    std::lock_guard<std::mutex> lk(mu_);
+    entries_.clear();
+    lru_.clear();
+    used_ = 0;
+}
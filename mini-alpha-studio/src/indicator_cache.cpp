@@ -0,0 +1,35 @@
+#include "indicator_cache.hpp"
+#include "strategy.hpp"
+
+SmaCache::SmaCache(SeriesPtr series, size_t budget_bytes)
+    : series_(std::move(series)), budget_(budget_bytes) {}
+
+const double* SmaCache::get(int w, std::vector<double>& scratch) {
+    const size_t n = series_->size();
+    Slot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = slots_.find(w);
+        if (it != slots_.end()) slot = it->second.get();
+        else if (used_ + n * sizeof(double) <= budget_) {
+            used_ += n * sizeof(double);
+            slot = (slots_[w] = std::make_unique<Slot>()).get();
+        }
+    }
+    if (!slot) {
+        compute_sma(series_->close.data(), n, w, scratch);
+        return scratch.data();
+    }
+    std::call_once(slot->once, [&]{ compute_sma(series_->close.data(), n, w, slot->values); });
+    return slot->values.data();
+}
+
+size_t SmaCache::windows_cached() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return slots_.size();
+}
+
+size_t SmaCache::bytes() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return used_;
+}
@@ -2,7 +2,10 @@
 #include "imgui.h"
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_opengl3.h"
+#include "backtest_session.hpp"
 #include "optimize.hpp"
+#include "opt_job.hpp"
+#include "plot_lod.hpp"
 
 #if __APPLE__
 #  include <OpenGL/gl3.h>
@@ -10,12 +13,19 @@
 #  include <GL/gl.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <string>
 #include <vector>
 #include <fstream>
 #include <filesystem>
 
 #include "csv.hpp"
+#include "dataset_registry.hpp"
 #include "strategy.hpp"
 
 static void export_run(const BacktestResult& r) {
@@ -52,56 +62,179 @@ Plotly.newPlot('plot',[
 </script>)";
 }
 
-static void DrawPriceWithTrades(const std::vector<BacktestPoint>& curve,
+// YYYY-MM-DD of a UTC epoch-ms timestamp.
+static void FormatDate(int64_t ts_ms, char* buf, size_t size)
+{
+    const std::time_t t = std::time_t(ts_ms / 1000);
+    const std::tm* tm = std::gmtime(&t);
+    if (!tm || !std::strftime(buf, size, "%Y-%m-%d", tm)) std::snprintf(buf, size, "?");
+}
+
+// Visible part of the price and equity plots, as a fractional range of
+// curve indices. Both plots share one so they zoom and pan together.
+struct PlotView {
+    double begin = 0.0, end = 0.0;   // end <= begin: the whole curve
+
+    // Fits the view to an n-point curve: the whole of it when unset, else
+    // the same span (at most n) moved back inside.
+    void clamp(size_t n) {
+        if (end <= begin) { begin = 0.0; end = double(n); }
+        const double s = std::min(end - begin, double(n));
+        begin = std::clamp(begin, 0.0, double(n) - s);
+        end   = begin + s;
+    }
+    size_t first() const { return size_t(begin); }                  // visible indices
+    size_t last()  const { return size_t(std::ceil(end)); }          // [first, last)
+    float  x_of(double i, float x0, float w) const { return x0 + float((i - begin) / (end - begin)) * w; }
+};
+
+// Zoom and pan on the last item (a plot's InvisibleButton spanning x0..x0+w):
+// the wheel zooms around the cursor, dragging pans, a double-click shows all.
+// The view is fitted to the curve even when there is nothing to zoom.
+static void ZoomPan(PlotView& v, size_t n, float x0, float w)
+{
+    v.clamp(n);
+    if (n < 2 || w < 1.0f) return;
+    const ImGuiIO& io = ImGui::GetIO();
+    if (ImGui::IsItemHovered()) {
+        if (io.MouseWheel != 0.0f) {
+            const double span = v.end - v.begin;
+            const double at   = v.begin + span * std::clamp((io.MousePos.x - x0) / w, 0.0f, 1.0f);
+            const double s    = std::clamp(span * std::pow(0.8, double(io.MouseWheel)),
+                                           std::min(double(n), 16.0), double(n));
+            v.begin = at - (at - v.begin) * s / span;
+            v.end   = v.begin + s;
+        }
+        if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) v.end = v.begin;   // all
+    }
+    if (ImGui::IsItemActive() && io.MouseDelta.x != 0.0f) {
+        const double d = -double(io.MouseDelta.x) * (v.end - v.begin) / w;
+        v.begin += d;
+        v.end   += d;
+    }
+    v.clamp(n);
+}
+
+// Screen geometry of one DrawLodSeries plot. It is kept until the series
+// (by version), the view, the y range or the canvas changes, so a frame that
+// changes none of them re-emits it without touching the pyramid.
+struct LodGeometry {
+    size_t  version = SIZE_MAX;
+    double  begin = 0.0, end = 0.0, lo = 0.0, hi = 0.0;
+    ImVec2  p0 = ImVec2(0, 0);
+    float   w = 0.0f, h = 0.0f;
+    std::vector<ImVec2>   band;   // per-column min..max, as segment end point pairs
+    std::vector<ImVec2>   line;   // the trace
+    std::vector<uint32_t> idx;    // scratch for the trace's indices
+    size_t  builds = 0;
+};
+
+// Draws the visible range of lod across the canvas at p0 (w x h, lo/hi at
+// the bottom/top) in O(w) primitives: each pixel column's min..max as a
+// faint bar, so spikes narrower than a pixel stay visible, under the LTTB
+// trace at about one point per pixel. version identifies lod's contents.
+static void DrawLodSeries(ImDrawList* draw, const SeriesLod& lod, size_t version, const PlotView& v,
+                          ImVec2 p0, float w, float h, double lo, double hi, ImU32 line_col, ImU32 band_col,
+                          LodGeometry& g)
+{
+    const size_t n = lod.size();
+    if (n == 0 || w < 1.0f) return;
+    if (g.version != version || g.begin != v.begin || g.end != v.end || g.lo != lo || g.hi != hi ||
+        g.p0.x != p0.x || g.p0.y != p0.y || g.w != w || g.h != h) {
+        g.version = version; g.begin = v.begin; g.end = v.end; g.lo = lo; g.hi = hi;
+        g.p0 = p0; g.w = w; g.h = h;
+        ++g.builds;
+
+        auto y_of = [&](float val) { return p0.y + (float)(1.0 - (val - lo) / (hi - lo)) * h; };
+        const size_t cols = size_t(w);
+        const size_t a = v.first(), b = std::min(n, v.last());
+        g.band.clear();
+        if (b - a > cols) {
+            const double per_col = (v.end - v.begin) / double(cols);
+            for (size_t c = 0; c < cols; ++c) {
+                const size_t c0 = std::min(n - 1, size_t(v.begin + double(c) * per_col));
+                const size_t c1 = std::clamp(size_t(v.begin + double(c + 1) * per_col), c0 + 1, n);
+                const auto mm = lod.minmax(c0, c1);
+                const float x = p0.x + float(c) + 0.5f;
+                g.band.push_back(ImVec2(x, y_of(mm.second)));
+                g.band.push_back(ImVec2(x, y_of(mm.first) + 1.0f));
+            }
+        }
+        lod.trace(a, b, cols, g.idx);
+        g.line.clear();
+        for (uint32_t i : g.idx) g.line.push_back(ImVec2(v.x_of(double(i), p0.x, w), y_of(lod.value(i))));
+    }
+
+    draw->PushClipRect(p0, ImVec2(p0.x + w, p0.y + h), true);
+    for (size_t i = 0; i + 1 < g.band.size(); i += 2) draw->AddLine(g.band[i], g.band[i + 1], band_col);
+    draw->AddPolyline(g.line.data(), (int)g.line.size(), line_col, ImDrawFlags_None, 1.5f);
+    draw->PopClipRect();
+}
+
+static void DrawPriceWithTrades(const BarSeries& bars,
+                                const std::vector<BacktestPoint>& curve,
+                                const SeriesLod& px_lod,   // built from curve's px
                                 const std::vector<Trade>& trades,
+                                size_t version,            // bumped when prices or trades change
+                                LodGeometry& geometry,
+                                TradeClusters& markers,
+                                PlotView& view,
                                 float height_px = 300.0f)
 {
-    if (curve.empty()) { ImGui::TextDisabled("No data"); return; }
+    if (curve.empty() || px_lod.size() != curve.size()) { ImGui::TextDisabled("No data"); return; }
 
     // Canvas area
     ImVec2 p0 = ImGui::GetCursorScreenPos();
     float  w  = ImGui::GetContentRegionAvail().x;
     float  h  = height_px;
     ImVec2 p1 = ImVec2(p0.x + w, p0.y + h);
+    ImGui::InvisibleButton("price", ImVec2(w, h));
+    ZoomPan(view, curve.size(), p0.x, w);
 
     auto* draw = ImGui::GetWindowDrawList();
     // Frame
     draw->AddRect(p0, p1, IM_COL32(180,180,180,255));
 
-    // Find min/max price
-    double min_px = curve.front().px, max_px = curve.front().px;
-    for (auto& p : curve) { if (p.px < min_px) min_px = p.px; if (p.px > max_px) max_px = p.px; }
+    // Price range of the visible bars from the pyramid (O(log n)), then the
+    // decimated line
+    const size_t a = view.first(), b = std::min(curve.size(), view.last());
+    if (b <= a) return;
+    const auto range = px_lod.minmax(a, b);
+    double min_px = range.first, max_px = range.second;
     if (max_px <= min_px) max_px = min_px + 1.0; // avoid div by zero
 
-    const int N = (int)curve.size();
-    const float x_step = (N > 1) ? (w / float(N - 1)) : 0.0f;
-
-    // Line segments
-    for (int i=1; i<N; ++i) {
-        float x0 = p0.x + (i-1) * x_step;
-        float x1 = p0.x + (i)   * x_step;
-        float y0 = p0.y + (float)(1.0 - ( (curve[i-1].px - min_px) / (max_px - min_px) )) * h;
-        float y1 = p0.y + (float)(1.0 - ( (curve[i].px   - min_px) / (max_px - min_px) )) * h;
-        draw->AddLine(ImVec2(x0,y0), ImVec2(x1,y1), IM_COL32(200,200,255,255), 1.5f);
-    }
+    DrawLodSeries(draw, px_lod, version, view, p0, w, h, min_px, max_px,
+                  IM_COL32(200,200,255,255), IM_COL32(200,200,255,90), geometry);
 
-    // Trades (filled circles)
+    // Trades (filled circles), one marker per pixel column and side with
+    // the count when several share it. The clusters are rebuilt only when the
+    // trades, the view or the width change; trade idx are series indices, so
+    // they are placed through the curve by timestamp.
     const float R = 4.0f;
-    for (auto& tr : trades) {
-        if (tr.idx >= curve.size()) continue;
-        float x = p0.x + (float)tr.idx * x_step;
-        float y = p0.y + (float)(1.0 - ( (curve[tr.idx].px - min_px) / (max_px - min_px) )) * h;
-
-        if (tr.dir > 0) {
+    const auto& clusters = markers.update(version, bars, curve, trades, view.begin, view.end, size_t(w));
+    draw->PushClipRect(p0, p1, true);
+    for (const TradeCluster& c : clusters) {
+        float x = p0.x + float(c.column) + 0.5f;
+        float y = p0.y + (float)(1.0 - ( (c.px - min_px) / (max_px - min_px) )) * h;
+        float r = c.count > 1 ? R + std::min(6.0f, 1.5f * std::log2(float(c.count))) : R;
+
+        if (c.dir > 0) {
             // Buy = green
-            draw->AddCircleFilled(ImVec2(x,y), R, IM_COL32(40,200,90,255));
-            draw->AddCircle(ImVec2(x,y), R, IM_COL32(10,150,60,255), 0, 1.5f);
+            draw->AddCircleFilled(ImVec2(x,y), r, IM_COL32(40,200,90,255));
+            draw->AddCircle(ImVec2(x,y), r, IM_COL32(10,150,60,255), 0, 1.5f);
         } else {
             // Sell = red
-            draw->AddCircleFilled(ImVec2(x,y), R, IM_COL32(220,70,70,255));
-            draw->AddCircle(ImVec2(x,y), R, IM_COL32(160,40,40,255), 0, 1.5f);
+            draw->AddCircleFilled(ImVec2(x,y), r, IM_COL32(220,70,70,255));
+            draw->AddCircle(ImVec2(x,y), r, IM_COL32(160,40,40,255), 0, 1.5f);
+        }
+        if (c.count > 1) {
+            char label[16];
+            std::snprintf(label, sizeof(label), "%u", c.count);
+            const ImVec2 sz = ImGui::CalcTextSize(label);
+            draw->AddText(ImVec2(x - sz.x * 0.5f, y - r - sz.y), IM_COL32(230,230,230,255), label);
         }
     }
+    draw->PopClipRect();
 
     // Legend
     draw->AddRectFilled(ImVec2(p1.x-130, p0.y+8), ImVec2(p1.x-10, p0.y+46), IM_COL32(0,0,0,120), 6.0f);
@@ -111,8 +244,64 @@ static void DrawPriceWithTrades(const std::vector<BacktestPoint>& curve,
     draw->AddCircleFilled(ImVec2(p1.x-48, p0.y+30), R, IM_COL32(220,70,70,255));
     draw->AddText(ImVec2(p1.x-38,  p0.y+24), IM_COL32(230,230,230,255), "Sell");
 
-    // Advance the ImGui cursor so following items don’t overlap this canvas
-    ImGui::Dummy(ImVec2(w, h + 6.0f));
+    // Visible span, and room so following items don't overlap this canvas
+    char d0[16], d1[16];
+    FormatDate(curve[a].ts_ms, d0, sizeof(d0));
+    FormatDate(curve[b - 1].ts_ms, d1, sizeof(d1));
+    ImGui::TextDisabled("%s .. %s  (%zu of %zu bars; wheel zooms, drag pans, double-click shows all)",
+                        d0, d1, b - a, curve.size());
+}
+
+// Heatmap of an optimizer score surface: slow along x, fast along y (small
+// fast at the top), cold-to-hot by score. Unscored cells stay dark. Hovering
+// shows the pair; a click writes it to fast/slow and returns true.
+static bool DrawScoreHeatmap(const ScoreSurface& s, int& fast, int& slow, float height_px = 260.0f)
+{
+    if (s.score.empty()) { ImGui::TextDisabled("No score surface yet"); return false; }
+
+    float lo = FLT_MAX, hi = -FLT_MAX;
+    for (float v : s.score) if (!std::isnan(v)) { lo = std::min(lo, v); hi = std::max(hi, v); }
+    if (hi <= lo) hi = lo + 1.0f;
+
+    ImVec2 p0 = ImGui::GetCursorScreenPos();
+    float  w  = ImGui::GetContentRegionAvail().x;
+    float  h  = height_px;
+    ImVec2 p1 = ImVec2(p0.x + w, p0.y + h);
+    const float cw = w / float(s.cols()), ch = h / float(s.rows());
+
+    auto* draw = ImGui::GetWindowDrawList();
+    draw->AddRectFilled(p0, p1, IM_COL32(25,25,30,255));
+    for (int r = 0; r < s.rows(); ++r) {
+        for (int c = 0; c < s.cols(); ++c) {
+            const float v = s.score[size_t(r) * size_t(s.cols()) + size_t(c)];
+            if (std::isnan(v)) continue;
+            const float t = (v - lo) / (hi - lo);   // blue -> yellow -> red
+            const int   R = int(255 * std::min(1.0f, 2.0f * t));
+            const int   G = int(255 * (t < 0.5f ? 2.0f * t : 2.0f - 2.0f * t));
+            const int   B = int(255 * std::max(0.0f, 1.0f - 2.0f * t));
+            draw->AddRectFilled(ImVec2(p0.x + c * cw, p0.y + r * ch),
+                                ImVec2(p0.x + (c + 1) * cw, p0.y + (r + 1) * ch), IM_COL32(R, G, B, 255));
+        }
+    }
+    draw->AddRect(p0, p1, IM_COL32(180,180,180,255));
+
+    ImGui::InvisibleButton("heatmap", ImVec2(w, h));
+    bool picked = false;
+    if (ImGui::IsItemHovered()) {
+        const ImVec2 m = ImGui::GetMousePos();
+        const int c = std::clamp(int((m.x - p0.x) / cw), 0, s.cols() - 1);
+        const int r = std::clamp(int((m.y - p0.y) / ch), 0, s.rows() - 1);
+        const int f = s.fast_min + r, sl = s.slow_min + c;
+        const float v = s.at(f, sl);
+        if (std::isnan(v)) ImGui::SetTooltip("fast %d / slow %d: not scored", f, sl);
+        else               ImGui::SetTooltip("fast %d / slow %d: score %.3f", f, sl, v);
+        if (!std::isnan(v) && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+            fast = f; slow = sl; picked = true;
+        }
+    }
+    ImGui::TextDisabled("x: slow %d..%d   y: fast %d..%d   score %.3f (blue) .. %.3f (red)",
+                        s.slow_min, s.slow_max, s.fast_min, s.fast_max, lo, hi);
+    return picked;
 }
 
 
@@ -139,20 +328,74 @@ int main() {
     ImGui_ImplOpenGL3_Init("#version 150");
 
     // --- Load CSV (relative to CWD) ---
-    std::string warn, err;
-    auto bars = load_csv("sample_data/TSLA_5Y.csv", warn, err);
+    // Through the registry, so the optimizer reuses this series instead of
+    // reading TSLA again.
+    Dataset ds = DatasetRegistry::instance().get("sample_data/TSLA_5Y.csv");
+    const std::string& warn = ds.warn;
+    const std::string& err  = ds.err;
+    const CsvLoadStats& load_stats = ds.stats;
+    SeriesPtr data = ds.series ? ds.series : std::make_shared<const BarSeries>();
+    const BarSeries& bars = *data;
 
     // --- Backtest state ---
+    // params is what the controls edit; the session brings the result up to
+    // date with it each frame, recomputing only what an edit invalidated.
     MAParams params;
-    BacktestResult result = run_ma_crossover(bars, params);
+    BacktestSession session(data);
+
+    // Plot pyramids of the session's result, rebuilt when it changes: the
+    // price one only when the signal does (cost edits move equity only).
+    SeriesLod px_lod, eq_lod;
+    size_t    px_lod_version = SIZE_MAX, eq_lod_version = SIZE_MAX;
+    // Zoom/pan of both plots, in curve indices, and the price plot's trade
+    // markers for the current result and view
+    PlotView      view;
+    TradeClusters trade_markers;
+    LodGeometry   px_geometry, eq_geometry;   // cached screen geometry of each plot
+
+    // --- Redraw on demand ---
+    // The loop sleeps in SDL_WaitEvent once a few frames have been drawn
+    // since the last event (ImGui settles hover/active state over a frame or
+    // two), so an idle window costs no CPU. Background jobs wake it by
+    // pushing wake_event; wake_pending keeps at most one in the queue however
+    // often they report.
+    const Uint32      wake_event = SDL_RegisterEvents(1);
+    std::atomic<bool> wake_pending{false};
+    auto wake = [&] {
+        if (wake_event == (Uint32)-1 || wake_pending.exchange(true)) return;
+        SDL_Event ev{};
+        ev.type = wake_event;
+        SDL_PushEvent(&ev);
+    };
+    constexpr int kSettleFrames = 3;     // frames drawn after each wake
+    constexpr int kJobTickMs    = 250;   // elapsed/ETA refresh while a job runs
+    bool   on_demand   = true;           // false: draw every vsync, as before
+    int    redraw      = kSettleFrames;
+    size_t frames      = 0;
+
+    // --- Background grid search (cancelled and joined when main returns) ---
+    OptimizeJob opt_job(wake);
+    OptResult   opt_live;        // best so far of the running/last search
+    double      opt_seconds = 0.0;
 
     bool running = true;
     while (running) {
         SDL_Event e;
-        while (SDL_PollEvent(&e)) {
-            ImGui_ImplSDL2_ProcessEvent(&e);
-            if (e.type == SDL_QUIT) running = false;
+        auto handle = [&](const SDL_Event& ev) {
+            if (ev.type == wake_event) wake_pending = false;
+            else ImGui_ImplSDL2_ProcessEvent(&ev);
+            if (ev.type == SDL_QUIT) running = false;
+            redraw = kSettleFrames;
+        };
+        if (on_demand && redraw <= 0) {
+            // Nothing changed since the last frames: sleep until input or a
+            // job's wake (or the next elapsed-time tick while one runs).
+            if (opt_job.running() ? SDL_WaitEventTimeout(&e, kJobTickMs) : SDL_WaitEvent(&e)) handle(e);
+            redraw = kSettleFrames;
         }
+        while (SDL_PollEvent(&e)) handle(e);
+        if (redraw > 0) --redraw;
+        ++frames;
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
@@ -161,8 +404,19 @@ int main() {
         // Controls / stats
         ImGui::Begin("Controls");
         ImGui::Text("Bars loaded: %zu", bars.size());
+        ImGui::TextDisabled("Datasets cached: %.1f MB (%zu hits, %zu loads)",
+                            DatasetRegistry::instance().bytes_in_use() / 1e6,
+                            DatasetRegistry::instance().hits(), DatasetRegistry::instance().misses());
+        ImGui::TextDisabled("%s: %.1f MB in %.1f ms (%.0f MB/s, %u thread%s)",
+                            load_stats.from_cache ? "cache" : "parse",
+                            load_stats.bytes / 1e6, load_stats.seconds * 1e3, load_stats.mb_per_s(),
+                            load_stats.threads, load_stats.threads == 1 ? "" : "s");
         if (!warn.empty()) ImGui::TextColored(ImVec4(1,0.8f,0.2f,1), "WARN: %s", warn.c_str());
         if (!err.empty())  ImGui::TextColored(ImVec4(1,0.3f,0.3f,1), "ERR: %s", err.c_str());
+        ImGui::Checkbox("Redraw on demand", &on_demand);
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%zu frames drawn; plot geometry rebuilt %zu / %zu times)",
+                            frames, px_geometry.builds, eq_geometry.builds);
 
         int fast = params.fast, slow = params.slow;
         ImGui::SliderInt("Fast MA", &fast, 2, 200);
@@ -170,13 +424,13 @@ int main() {
         ImGui::SliderFloat("Fee (bps)", &params.fee_bps, 0.0f, 10.0f);
         ImGui::SliderFloat("Slippage (bps)", &params.slippage_bps, 0.0f, 20.0f);
 
-        bool recompute = false;
         if (fast != params.fast || slow != params.slow) {
-            if (fast < slow) { params.fast = fast; params.slow = slow; recompute = true; }
+            if (fast < slow) { params.fast = fast; params.slow = slow; }
             else ImGui::TextColored(ImVec4(1,0.4f,0.4f,1), "Fast must be < Slow");
         }
-        if (ImGui::Button("Recompute")) recompute = true;
-        if (recompute) result = run_ma_crossover(bars, params);
+        const BacktestResult& result = session.update(params);
+        ImGui::TextDisabled("Last update: %.2f ms (%zu signal scans, %zu pnl passes)",
+                            session.last_ms(), session.signal_runs(), session.pnl_runs());
 
         ImGui::Separator();
         ImGui::Text("PnL: %.2f | Max DD: %.2f | Sharpe (placeholder): %.2f",
@@ -207,39 +461,158 @@ if (show_opt) {
     static int fmin=5,fmax=60,smin=20,smax=200;
     ImGui::InputInt("fast min", &fmin); ImGui::SameLine(); ImGui::InputInt("fast max", &fmax);
     ImGui::InputInt("slow min", &smin); ImGui::SameLine(); ImGui::InputInt("slow max", &smax);
+    static int strategy = 0;
+    ImGui::Combo("search", &strategy, "grid\0coarse-to-fine\0successive halving\0random\0");
+
+    // The search runs on opt_job; this frame only polls it.
+    if (!opt_job.running()) {
+        if (ImGui::Button("Run search")) {
+            OptJobRequest req;
+            if (p0[0]) req.paths.push_back(p0);
+            if (p1[0]) req.paths.push_back(p1);
+            if (p2[0]) req.paths.push_back(p2);
+            if (p3[0]) req.paths.push_back(p3);
+            if (p4[0]) req.paths.push_back(p4);
+            req.base = params;
+            req.fast_min = fmin; req.fast_max = fmax;
+            req.slow_min = smin; req.slow_max = smax;
+            req.strategy = static_cast<SearchStrategy>(strategy);
+            req.store_path = "reports/opt_results.store";
+            opt_live = OptResult{};
+            opt_job.start(std::move(req));
+        }
+    } else {
+        if (ImGui::Button("Cancel")) opt_job.cancel();
+        const size_t done = opt_job.progress().done, total = opt_job.progress().total;
+        char label[96];
+        if (total == 0) std::snprintf(label, sizeof(label), "loading datasets...");
+        else            std::snprintf(label, sizeof(label), "%zu / %zu pairs", done, total);
+        ImGui::SameLine();
+        ImGui::ProgressBar(total ? float(done) / float(total) : 0.0f, ImVec2(-1, 0), label);
+        const double eta = opt_job.eta_s();
+        if (eta >= 0.0) ImGui::TextDisabled("%.1f s elapsed, ~%.1f s left", opt_job.elapsed_s(), eta);
+        else            ImGui::TextDisabled("%.1f s elapsed", opt_job.elapsed_s());
+    }
 
-    if (ImGui::Button("Run grid search")) {
-        std::vector<std::string> paths;
-        if (p0[0]) paths.push_back(p0);
-        if (p1[0]) paths.push_back(p1);
-        if (p2[0]) paths.push_back(p2);
-        if (p3[0]) paths.push_back(p3);
-        if (p4[0]) paths.push_back(p4);
-
-        auto opt = grid_search_fast_slow(paths, params, fmin, fmax, smin, smax);
-        if (opt.best_fast>0) {
-            params.fast = opt.best_fast;
-            params.slow = opt.best_slow;
-            result = run_ma_crossover(bars, params);
+    opt_job.take_best(opt_live);
+    if (opt_live.best_fast > 0)
+        ImGui::Text("Best %s: fast %d / slow %d (score %.3f)",
+                    opt_job.running() ? "so far" : (opt_live.cancelled ? "before cancel" : "found"),
+                    opt_live.best_fast, opt_live.best_slow, opt_live.best_score);
+
+    OptJobResult fin;
+    if (opt_job.take_result(fin)) {
+        opt_live    = fin.opt;
+        opt_seconds = fin.seconds;
+        if (fin.opt.best_fast > 0) {
+            params.fast = fin.opt.best_fast;
+            params.slow = fin.opt.best_slow;
         }
     }
+    if (!opt_job.running() && opt_seconds > 0.0)
+        ImGui::TextDisabled("Last search: %.2f s, %zu backtests, %zu from the result store%s", opt_seconds,
+                            opt_live.evaluations, opt_live.store_hits, opt_live.cancelled ? " (cancelled)" : "");
 }
 
         ImGui::End();
 
+        if (px_lod_version != session.signal_version()) {
+            // Curves all end at the last bar; a slow window of another length
+            // only moves where they start, so keep the view on the same bars.
+            const double shift = double(result.curve.size()) - double(px_lod.size());
+            if (!px_lod.empty() && view.end > view.begin) { view.begin += shift; view.end += shift; }
+            px_lod.build(result.curve, &BacktestPoint::px);
+            px_lod_version = session.signal_version();
+        }
+        if (eq_lod_version != session.version()) {
+            eq_lod.build(result.curve, &BacktestPoint::equity);
+            eq_lod_version = session.version();
+        }
+
         // Equity plot
         ImGui::Begin("Equity Curve");
-        static std::vector<float> eq;
-        eq.clear(); eq.reserve(result.curve.size());
-        for (auto& p : result.curve) eq.push_back((float)p.equity);
-        if (!eq.empty()) ImGui::PlotLines("Equity", eq.data(), (int)eq.size(), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(-1, 300));
+        if (!eq_lod.empty() && eq_lod.size() == result.curve.size()) {
+            ImVec2 p0 = ImGui::GetCursorScreenPos();
+            float  w  = ImGui::GetContentRegionAvail().x, h = 300.0f;
+            auto*  draw = ImGui::GetWindowDrawList();
+            ImGui::InvisibleButton("equity", ImVec2(w, h));
+            ZoomPan(view, eq_lod.size(), p0.x, w);
+            const size_t a = view.first(), b = std::min(eq_lod.size(), view.last());
+            if (b > a) {
+                const auto range = eq_lod.minmax(a, b);
+                const double lo = range.first, hi = range.second > range.first ? range.second : range.first + 1.0;
+                draw->AddRectFilled(p0, ImVec2(p0.x + w, p0.y + h), IM_COL32(35,35,40,255));
+                DrawLodSeries(draw, eq_lod, eq_lod_version, view, p0, w, h, lo, hi,
+                              IM_COL32(230,180,90,255), IM_COL32(230,180,90,90), eq_geometry);
+                if (ImGui::IsItemHovered() && !ImGui::IsItemActive() && w > 0.0f) {
+                    const float  t = std::clamp((ImGui::GetMousePos().x - p0.x) / w, 0.0f, 1.0f);
+                    const size_t i = std::min(eq_lod.size() - 1, size_t(view.begin + double(t) * (view.end - view.begin)));
+                    char d[16];
+                    FormatDate(result.curve[i].ts_ms, d, sizeof(d));
+                    ImGui::SetTooltip("%s: %.2f", d, result.curve[i].equity);
+                }
+                ImGui::TextDisabled("equity %.2f .. %.2f", lo, hi);
+            }
+        }
         ImGui::End();
 
         // Price plot
         ImGui::Begin("Price (with trades)");
-        DrawPriceWithTrades(result.curve, result.trades, 300.0f);
+        DrawPriceWithTrades(session.series(), result.curve, px_lod, result.trades, px_lod_version,
+                            px_geometry, trade_markers, view, 300.0f);
         ImGui::End();
 
+        // Score surface and top pairs of the last search; clicking either
+        // loads that pair.
+        if (!opt_live.surface.score.empty()) {
+            ImGui::Begin("Score Surface");
+            int pf = params.fast, ps = params.slow;
+            bool pick = DrawScoreHeatmap(opt_live.surface, pf, ps);
+            if (ImGui::BeginTable("top", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("fast/slow");
+                ImGui::TableSetupColumn("score");
+                ImGui::TableSetupColumn("avg pnl");
+                ImGui::TableSetupColumn("avg max dd");
+                ImGui::TableSetupColumn("avg trades");
+                ImGui::TableSetupColumn("score per dataset");
+                ImGui::TableHeadersRow();
+                for (const OptCandidate& c : opt_live.top) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    char label[32];
+                    std::snprintf(label, sizeof(label), "%d / %d", c.fast, c.slow);
+                    if (ImGui::Button(label)) { pf = c.fast; ps = c.slow; pick = true; }
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", c.score);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", c.pnl);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", c.max_dd);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", c.trades);
+                    ImGui::TableNextColumn();
+                    std::string per;
+                    for (const DatasetScore& d : c.datasets) {
+                        char buf[24];
+                        std::snprintf(buf, sizeof(buf), per.empty() ? "%.2f" : "  %.2f", d.score);
+                        per += buf;
+                    }
+                    ImGui::TextUnformatted(per.c_str());
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::BeginTooltip();
+                        for (size_t i = 0; i < c.datasets.size(); ++i) {
+                            const DatasetScore& d = c.datasets[i];
+                            ImGui::Text("#%zu  score %.3f  pnl %.2f  max dd %.2f  %zu trades",
+                                        i + 1, d.score, d.pnl, d.max_dd, d.trades);
+                        }
+                        ImGui::EndTooltip();
+                    }
+                }
+                ImGui::EndTable();
+            }
+            if (pick) {
+                params.fast = pf;
+                params.slow = ps;
+            }
+            ImGui::End();
+        }
+
 
         // Render
         ImGui::Render();
@@ -251,7 +624,8 @@ if (show_opt) {
         SDL_GL_SwapWindow(window);
     }
 
-    // Cleanup
+    // Cleanup. Stop the search first: its wakes post to SDL's event queue.
+    opt_job.stop();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
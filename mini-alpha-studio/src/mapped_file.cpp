@@ -0,0 +1,63 @@
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+  #include <fstream>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+  if (this == &o) return *this;
+  close();
+  buf_    = std::move(o.buf_);
+  data_   = o.mapped_ ? o.data_ : buf_.data();
+  size_   = o.size_;
+  open_   = o.open_;
+  mapped_ = o.mapped_;
+  o.data_ = nullptr; o.size_ = 0; o.open_ = false; o.mapped_ = false;
+  return *this;
+}
+
+void MappedFile::close(){
+#if !defined(_WIN32)
+  if (mapped_ && data_) munmap(const_cast<char*>(data_), size_);
+#endif
+  buf_.clear(); buf_.shrink_to_fit();
+  data_ = nullptr; size_ = 0; open_ = false; mapped_ = false;
+}
+
+bool MappedFile::open(const std::string& path, std::string& err){
+  close();
+#if !defined(_WIN32)
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0){ err = "Cannot open " + path; return false; }
+  struct stat st{};
+  if (fstat(fd, &st) != 0){ ::close(fd); err = "Cannot stat " + path; return false; }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0){
+    void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED){ ::close(fd); size_ = 0; err = "Cannot map " + path; return false; }
+  #if defined(MADV_SEQUENTIAL)
+    madvise(p, size_, MADV_SEQUENTIAL);
+  #endif
+    data_ = static_cast<const char*>(p);
+    mapped_ = true;
+  }
+  ::close(fd);  // the mapping keeps its own reference
+#else
+  std::ifstream f(path, std::ios::binary | std::ios::ate);
+  if (!f){ err = "Cannot open " + path; return false; }
+  size_ = static_cast<size_t>(f.tellg());
+  buf_.resize(size_);
+  f.seekg(0);
+  if (size_ && !f.read(buf_.data(), static_cast<std::streamsize>(size_))){
+    close(); err = "Cannot read " + path; return false;
+  }
+  data_ = buf_.data();
+#endif
+  open_ = true;
+  return true;
+}
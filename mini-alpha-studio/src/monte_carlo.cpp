@@ -0,0 +1,196 @@
+#include "monte_carlo.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+uint64_t mix64(uint64_t z){
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// SplitMix64 in counter mode: draw i of a stream is mix64(key + i * gamma),
+// a pure function of (key, i), so a scenario's draws never depend on what
+// other scenarios or threads did.
+struct CounterRng {
+    uint64_t key = 0, ctr = 0;
+
+    CounterRng(uint64_t seed, unsigned kind, size_t scenario)
+        : key(mix64(mix64(seed) + (uint64_t(kind) << 56) + uint64_t(scenario))) {}
+
+    uint64_t next()    { return mix64(key + (++ctr) * 0x9E3779B97F4A7C15ull); }
+    double   uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }   // [0, 1)
+    size_t   below(size_t n) { return std::min(n - 1, static_cast<size_t>(uniform() * static_cast<double>(n))); }
+};
+
+enum Kind : unsigned { kBootstrap, kShuffle, kCosts, kKinds };
+
+// Running max drawdown of a path that starts at 0, as CrossoverState::mark.
+struct Drawdown {
+    double peak = 0.0, dd = 0.0;
+    void add(double equity){
+        peak = std::max(peak, equity);
+        dd   = std::max(dd, peak - equity);
+    }
+};
+
+void summarize(ScenarioDist& d){
+    const size_t n = d.pnl.size();
+    if (n == 0) return;
+    RunningMoments pnl, dd;
+    size_t losses = 0;
+    for (size_t i = 0; i < n; ++i){
+        pnl.add(d.pnl[i]);
+        dd.add(d.max_dd[i]);
+        losses += d.pnl[i] < 0.0;
+    }
+    d.pnl_mean  = pnl.get_mean();
+    d.pnl_std   = pnl.get_std();
+    d.dd_mean   = dd.get_mean();
+    d.dd_std    = dd.get_std();
+    d.loss_rate = static_cast<double>(losses) / static_cast<double>(n);
+    std::sort(d.pnl.begin(), d.pnl.end());
+    std::sort(d.max_dd.begin(), d.max_dd.end());
+}
+
+double quantile(const std::vector<double>& sorted, double q){
+    if (sorted.empty()) return NAN;
+    const double r = std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(sorted.size()));
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(std::max(1.0, r)) - 1)];
+}
+
+} // namespace
+
+double ScenarioDist::pnl_quantile(double q) const { return quantile(pnl, q); }
+double ScenarioDist::dd_quantile(double q) const  { return quantile(max_dd, q); }
+
+RobustnessResult robustness_analysis(const BacktestResult& r, const MAParams& p,
+                                     const RobustnessSpec& spec, const RobustnessOptions& opt)
+{
+    RobustnessResult out;
+    out.base_pnl    = r.pnl;
+    out.base_max_dd = r.max_dd;
+    const size_t n = r.curve.size();
+
+    // Read-only inputs shared by every scenario: per-bar equity changes,
+    // traded notional up to each bar, and the round-trip PnLs.
+    const double bps = (static_cast<double>(p.fee_bps) + static_cast<double>(p.slippage_bps)) / 10000.0;
+    std::vector<double> step(n), notional(n), trips;
+    double prev = 0.0, traded = 0.0, entry = 0.0;
+    bool   open = false;
+    size_t t = 0;
+    for (size_t k = 0; k < n; ++k){
+        const BacktestPoint& pt = r.curve[k];
+        for (; t < r.trades.size() && r.trades[t].ts_ms <= pt.ts_ms; ++t){
+            const Trade& tr = r.trades[t];
+            traded += tr.px;
+            if (tr.dir > 0){ entry = tr.px; open = true; }
+            else if (open) { trips.push_back(tr.px * (1.0 - bps) - entry * (1.0 + bps)); open = false; }
+        }
+        step[k]     = pt.equity - prev;
+        notional[k] = traded;
+        prev        = pt.equity;
+    }
+    if (open && n > 0) trips.push_back(r.curve.back().px - entry * (1.0 + bps));
+    out.trips = trips.size();
+
+    bool enabled[kKinds] = {spec.bootstrap && n > 0, spec.shuffle && !trips.empty(), spec.costs && n > 0};
+    ScenarioDist* dist[kKinds] = {&out.bootstrap, &out.shuffle, &out.costs};
+    const size_t S = spec.scenarios;
+    size_t total = 0;
+    for (unsigned k = 0; k < kKinds; ++k)
+        if (enabled[k]){
+            dist[k]->pnl.resize(S);
+            dist[k]->max_dd.resize(S);
+            total += S;
+        }
+    if (total == 0) return out;
+    if (opt.progress){ opt.progress->done = 0; opt.progress->total = total; }
+
+    const size_t block = std::max<size_t>(1, spec.block_bars);
+    auto bootstrap = [&](CounterRng& rng, double& pnl, double& max_dd){
+        Drawdown dd;
+        double eq = 0.0;
+        for (size_t filled = 0; filled < n;){
+            size_t i = rng.below(n);
+            for (size_t j = 0; j < block && filled < n; ++j, ++filled){
+                eq += step[i];
+                dd.add(eq);
+                if (++i == n) i = 0;
+            }
+        }
+        pnl = eq; max_dd = dd.dd;
+    };
+    auto shuffle = [&](CounterRng& rng, std::vector<double>& buf, double& pnl, double& max_dd){
+        std::copy(trips.begin(), trips.end(), buf.begin());
+        for (size_t i = buf.size() - 1; i > 0; --i) std::swap(buf[i], buf[rng.below(i + 1)]);
+        Drawdown dd;
+        double eq = 0.0;
+        for (double v : buf){ eq += v; dd.add(eq); }
+        pnl = eq; max_dd = dd.dd;
+    };
+    auto costs = [&](CounterRng& rng, double& pnl, double& max_dd){
+        const double fee  = static_cast<double>(p.fee_bps)      + spec.fee_jitter_bps      * (2.0 * rng.uniform() - 1.0);
+        const double slip = static_cast<double>(p.slippage_bps) + spec.slippage_jitter_bps * (2.0 * rng.uniform() - 1.0);
+        // Each trade's cash moves by px * (change in bps) either way.
+        const double delta = std::max(0.0, fee + slip) / 10000.0 - bps;
+        Drawdown dd;
+        double eq = 0.0;
+        for (size_t k = 0; k < n; ++k){
+            eq = r.curve[k].equity - delta * notional[k];
+            dd.add(eq);
+        }
+        pnl = eq; max_dd = dd.dd;
+    };
+
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool* pool = pool_for(opt.threads, own);
+
+    // Shuffle buffers, one per thread, allocated once for every scenario.
+    PerThread<std::vector<double>> scratch(pool, std::vector<double>(trips.size()));
+    auto cancelled = [&]{ return opt.cancel && opt.cancel->load(std::memory_order_relaxed); };
+
+    // One task per chunk of one kind; scenario s writes slot s of its kind.
+    constexpr size_t kChunk = 1024;
+    const size_t chunks = (S + kChunk - 1) / kChunk;
+    auto run_chunk = [&](size_t task){
+        const unsigned kind = static_cast<unsigned>(task / chunks);
+        if (!enabled[kind] || cancelled()) return;
+        const size_t s0 = task % chunks * kChunk, s1 = std::min(S, s0 + kChunk);
+        ScenarioDist& d = *dist[kind];
+        if (kind == kShuffle){
+            auto buf = scratch.local();
+            for (size_t s = s0; s < s1; ++s){
+                CounterRng rng(spec.seed, kind, s);
+                shuffle(rng, *buf, d.pnl[s], d.max_dd[s]);
+            }
+        } else {
+            for (size_t s = s0; s < s1; ++s){
+                CounterRng rng(spec.seed, kind, s);
+                if (kind == kBootstrap) bootstrap(rng, d.pnl[s], d.max_dd[s]);
+                else                    costs(rng, d.pnl[s], d.max_dd[s]);
+            }
+        }
+        if (opt.progress) opt.progress->done.fetch_add(s1 - s0, std::memory_order_relaxed);
+    };
+    if (pool) pool->parallel_for(kKinds * chunks, run_chunk);
+    else for (size_t i = 0; i < kKinds * chunks; ++i) run_chunk(i);
+
+    out.cancelled = cancelled();
+    for (unsigned k = 0; k < kKinds; ++k){
+        if (out.cancelled) *dist[k] = ScenarioDist{};
+        else summarize(*dist[k]);
+    }
+    return out;
+}
+
+RobustnessResult robustness_analysis(const BarSeries& bars, const MAParams& p,
+                                     const RobustnessSpec& spec, const RobustnessOptions& opt)
+{
+    BacktestWorkspace ws;
+    return robustness_analysis(run_ma_crossover(bars, p, ws), p, spec, opt);
+}
@@ -0,0 +1,66 @@
+#include "opt_job.hpp"
+#include <cstdio>
+#include <utility>
+
+OptimizeJob::OptimizeJob(std::function<void()> notify) : notify_(std::move(notify)) {
+    progress_.notify = notify_;
+}
+
+void OptimizeJob::stop() {
+    cancel_ = true;
+    if (thread_.joinable()) thread_.join();
+}
+
+bool OptimizeJob::start(OptJobRequest req) {
+    if (running()) return false;
+    if (thread_.joinable()) thread_.join();   // previous search has finished
+
+    // Drop anything the previous search left unread.
+    OptResult stale;
+    while (progress_.best.take(stale)) {}
+    progress_.done  = 0;
+    progress_.total = 0;
+    cancel_  = false;
+    running_ = true;
+    t0_      = std::chrono::steady_clock::now();
+
+    thread_ = std::thread([this, req = std::move(req)] {
+        OptOptions o;
+        o.progress = &progress_;
+        o.cancel   = &cancel_;
+        o.strategy = req.strategy;
+        if (!req.store_path.empty()) {
+            // Reopen for a new file; otherwise just pick up what other
+            // processes appended since the last search.
+            std::string err;
+            if (store_.path() == req.store_path) store_.refresh();
+            else if (!store_.open(req.store_path, err)) std::fprintf(stderr, "%s\n", err.c_str());
+            if (store_.is_open() && store_.path() == req.store_path) o.store = &store_;
+        }
+
+        OptJobResult r;
+        r.opt = grid_search_fast_slow(req.paths, req.base, req.fast_min, req.fast_max,
+                                      req.slow_min, req.slow_max, o);
+        if (req.replay && r.opt.best_fast > 0) {
+            MAParams p = req.base;
+            p.fast = r.opt.best_fast;
+            p.slow = r.opt.best_slow;
+            r.run = run_ma_crossover(*req.replay, p);
+        }
+        r.seconds = elapsed_s();
+        result_.post(std::move(r));
+        running_.store(false, std::memory_order_release);
+        if (notify_) notify_();
+    });
+    return true;
+}
+
+double OptimizeJob::elapsed_s() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_).count();
+}
+
+double OptimizeJob::eta_s() const {
+    const size_t done = progress_.done.load(), total = progress_.total.load();
+    if (done == 0 || total == 0) return -1.0;
+    return elapsed_s() * static_cast<double>(total - done) / static_cast<double>(done);
+}
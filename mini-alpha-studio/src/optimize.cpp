@@ -1,8 +1,19 @@
 #include "optimize.hpp"
-#include "csv.hpp"
+#include "dataset_registry.hpp"
+#include "indicator_cache.hpp"
+#include "result_store.hpp"
+#include "thread_pool.hpp"
+#include "worker_procs.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
 
-static double score_run(const BacktestResult& r){
+double score_run(const BacktestStats& r){
     // Simple score: avg PnL over files, lightly penalize drawdown
     return r.pnl / (1.0 + r.max_dd);
 }
@@ -10,37 +21,564 @@ static double score_run(const BacktestResult& r){
 OptResult grid_search_fast_slow(const std::vector<std::string>& csv_paths,
                                 const MAParams& base,
                                 int fast_min, int fast_max,
-                                int slow_min, int slow_max)
+                                int slow_min, int slow_max,
+                                const OptOptions& opt)
 {
-    OptResult out;
-    if (csv_paths.empty()) return out;
-
-    // Preload all files once
-    std::vector<std::vector<Bar>> datasets;
+    // Shared, load-once datasets (only the first search reads the files)
+    std::vector<SeriesPtr> datasets;
     datasets.reserve(csv_paths.size());
-    for (auto& path : csv_paths){
-        std::string warn, err;
-        auto bars = load_csv(path, warn, err);
-        if (!err.empty() || bars.empty()) continue;
-        datasets.push_back(std::move(bars));
-    }
-    if (datasets.empty()) return out;
-
-    for (int f = fast_min; f <= fast_max; ++f){
-        for (int s = std::max(slow_min, f+1); s <= slow_max; ++s){
-            double total = 0.0; int used = 0;
-            MAParams p = base; p.fast = f; p.slow = s;
-            for (auto& ds : datasets){
-                auto r = run_ma_crossover(ds, p);
-                total += score_run(r);
-                ++used;
+    for (auto& d : DatasetRegistry::instance().get_many(csv_paths)){
+        if (!d.err.empty() || !d.series || d.series->empty()) continue;
+        datasets.push_back(std::move(d.series));
+    }
+    return grid_search_fast_slow(datasets, base, fast_min, fast_max, slow_min, slow_max, opt);
+}
+
+OptResult grid_search_fast_slow(const std::vector<BarSeries>& datasets,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt)
+{
+    // Non-owning handles; the caller keeps the series alive for the call.
+    std::vector<SeriesPtr> ptrs;
+    ptrs.reserve(datasets.size());
+    for (auto& ds : datasets) ptrs.push_back(SeriesPtr(SeriesPtr(), &ds));
+    return grid_search_fast_slow(ptrs, base, fast_min, fast_max, slow_min, slow_max, opt);
+}
+
+namespace {
+
+using Cell = std::pair<int,int>;   // (fast, slow); ordered like the serial grid loop
+
+// Best cell under the search-wide order: higher score first, then the earlier
+// cell in (fast, slow) order, which is the serial grid's first-best rule. NaN
+// and scores not above the OptResult default never win.
+struct Best {
+    double score = -1e300;
+    Cell   cell{0, 0};
+    bool   set = false;
+
+    bool offer(double sc, Cell c){
+        if (!(sc > -1e300)) return false;
+        if (set && !(sc > score || (sc == score && c < cell))) return false;
+        score = sc; cell = c; set = true;
+        return true;
+    }
+    void merge(const Best& o){ if (o.set) offer(o.score, o.cell); }
+};
+
+// The k best cells under Best's order, best first.
+struct TopK {
+    using Item = std::pair<double, Cell>;
+    size_t k = 1;
+    std::vector<Item> items;
+
+    static bool before(const Item& a, const Item& b){
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    }
+    void offer(double sc, Cell c){
+        if (!(sc > -1e300)) return;
+        const Item v{sc, c};
+        if (items.size() == k && !before(v, items.back())) return;
+        items.insert(std::upper_bound(items.begin(), items.end(), v, before), v);
+        if (items.size() > k) items.pop_back();
+    }
+    void merge(const TopK& o){ for (const Item& v : o.items) offer(v.first, v.second); }
+};
+
+struct GridRange {
+    int fast_min, fast_max, slow_min, slow_max;
+    bool contains(Cell c) const {
+        return c.first >= fast_min && c.first <= fast_max &&
+               c.second >= std::max(slow_min, c.first + 1) && c.second <= slow_max;
+    }
+};
+
+
+// Scores lists of cells on every dataset in parallel; all strategies go
+// through it. One SMA memo per dataset lives for the whole search (or longer,
+// when the caller owns them), so every distinct window is computed once
+// however many rounds a strategy runs.
+class Scorer {
+public:
+    Scorer(const std::vector<std::shared_ptr<SmaCache>>& smas, const MAParams& base, const GridRange& g,
+           const OptOptions& opt)
+        : base_(base), opt_(opt)
+    {
+        for (auto& sma : smas){
+            if (!sma) continue;
+            const size_t n = sma->series().size();
+            const size_t b = std::min(opt.bar_begin, n), e = std::min(opt.bar_end, n);
+            if (b >= e) continue;
+            caches_.push_back({sma, b, e});
+            total_bars_ += e - b;
+        }
+        pool_ = pool_for(opt.threads, own_);
+        TopK top;
+        top.k = std::max<size_t>(1, opt.top_k);
+        tops_.reset(pool_, top);
+        surface_.fast_min = g.fast_min; surface_.fast_max = g.fast_max;
+        surface_.slow_min = g.slow_min; surface_.slow_max = g.slow_max;
+        if (surface_.rows() > 0 && surface_.cols() > 0)
+            surface_.score.assign(size_t(surface_.rows()) * size_t(surface_.cols()), NAN);
+        if (opt.progress){ opt.progress->done = 0; opt.progress->total = 0; }
+        if (opt.store){
+            hashes_.resize(caches_.size());
+            for_each_task(caches_.size(), [&](size_t d){ hashes_[d] = series_hash(caches_[d].sma->series()); });
+        }
+    }
+
+    bool   empty()      const { return caches_.empty(); }
+    size_t total_bars() const { return total_bars_; }
+    bool   cancelled()  const { return opt_.cancel && opt_.cancel->load(std::memory_order_relaxed); }
+
+    // Average score of each cell over the datasets, NaN where cancellation
+    // stopped it. Each dataset is cut to the opt.bar_begin/bar_end window. With
+    // a budget below total_bars() only the most recent bars are used: datasets
+    // are taken in order, each cut to its last min(window, budget left) bars.
+    // Every cut runs with its MAs already warmed up on the bars before it. Full-budget scores are exactly the
+    // grid's and feed the surface, the top-K and the live best in opt.progress.
+    std::vector<double> score(const std::vector<Cell>& cells, size_t budget = SIZE_MAX){
+        std::vector<double> avg(cells.size(), NAN);
+        if (cells.empty() || caches_.empty()) return avg;
+
+        // whole: the slice is the entire series, so its results can be stored.
+        struct Slice { size_t d, off, len; bool whole; };
+        std::vector<Slice> slices;
+        size_t left = budget;
+        for (size_t d = 0; d < caches_.size() && left > 0; ++d){
+            const Window& w = caches_[d];
+            const size_t len = std::min(w.end - w.begin, left);
+            slices.push_back({d, w.end - len, len, len == w.sma->series().size()});
+            left -= len;
+        }
+        const Slice& last = slices.back();
+        const bool full = slices.size() == caches_.size() && last.off == caches_[last.d].begin;
+
+        // One task per (tile, slice). A tile is kBacktestLanes cells scored by
+        // the lane-batched kernel on one slice; the task that scores a tile's
+        // last slice averages its cells (slices added in order, as the serial
+        // loop did) and folds them into its thread's best.
+        constexpr size_t T = kBacktestLanes;
+        const size_t C = cells.size(), S = slices.size();
+        const size_t tiles = (C + T - 1) / T, tasks = tiles * S;
+        if (opt_.progress) opt_.progress->total.fetch_add(C);
+
+        // The stats of every (cell, slice) backtest and where they came from.
+        // With worker processes both live in memory the workers share.
+        enum : uint8_t { kPending = 0, kStored = 1, kRun = 2 };
+        const bool procs = opt_.processes > 1 && worker_processes_supported();
+        SharedArray<BacktestStats> stats(C * S, procs);
+        SharedArray<uint8_t>       state(C * S, procs);
+        std::vector<double>        scores(C * S);   // [cell][slice]
+
+        // A task is one (tile, slice): kBacktestLanes cells scored by the
+        // lane-batched kernel on one slice. Whole-dataset runs already in
+        // the store are read back first; the rest are packed into the front
+        // lanes and run as one batch.
+        auto lookup = [&](size_t task){
+            const Slice& sl = slices[task % S];
+            if (!opt_.store || !sl.whole) return;
+            const size_t c0 = task / S * T, k = std::min(T, C - c0);
+            for (size_t c = c0; c < c0 + k; ++c){
+                MAParams p = base_;
+                p.fast = cells[c].first;
+                p.slow = cells[c].second;
+                if (opt_.store->find(hashes_[sl.d], p, stats[c*S + task % S])) state[c*S + task % S] = kStored;
+            }
+        };
+        // column(slice, window, scratch) supplies the SMA columns; idx is the
+        // kernel's trade-bar buffer.
+        auto run_with = [&](size_t task, auto&& column, std::vector<size_t>& idx){
+            const Slice& sl = slices[task % S];
+            const size_t c0 = task / S * T, k = std::min(T, C - c0);
+            BacktestLane  lanes[T];
+            BacktestStats res[T];
+            size_t        lane_cell[T];
+            size_t        m = 0;
+            std::vector<double> scratch[2 * T];   // only used past the cache budget
+            auto at = [&](int w, std::vector<double>& buf){
+                const double* col = column(task % S, w, buf);
+                return col ? col + sl.off : col;
+            };
+            for (size_t c = c0; c < c0 + k; ++c){
+                if (state[c*S + task % S] != kPending) continue;
+                lanes[m].p       = base_;
+                lanes[m].p.fast  = cells[c].first;
+                lanes[m].p.slow  = cells[c].second;
+                lanes[m].fast_ma = at(lanes[m].p.fast, scratch[2*m]);
+                lanes[m].slow_ma = at(lanes[m].p.slow, scratch[2*m+1]);
+                lane_cell[m++]   = c;
             }
-            if (used>0 && total/used > out.best_score){
-                out.best_score = total/used;
-                out.best_fast  = f;
-                out.best_slow  = s;
+            if (m == 0) return;
+            run_ma_crossover_stats_batch(caches_[sl.d].sma->series().close.data() + sl.off, sl.len, lanes, m, res, idx);
+            for (size_t l = 0; l < m; ++l){
+                stats[lane_cell[l]*S + task % S] = res[l];
+                state[lane_cell[l]*S + task % S] = kRun;
+            }
+        };
+        auto run = [&](size_t task){
+            std::vector<size_t> idx;
+            run_with(task, [&](size_t j, int w, std::vector<double>& buf){ return caches_[slices[j].d].sma->get(w, buf); }, idx);
+        };
+        // Scores a finished task and stores its new results; false if some
+        // of its backtests never ran (cancelled, or lost with a worker).
+        auto post = [&](size_t task){
+            const Slice& sl = slices[task % S];
+            const size_t c0 = task / S * T, k = std::min(T, C - c0);
+            size_t ran = 0, hits = 0;
+            for (size_t c = c0; c < c0 + k; ++c){
+                const size_t i = c*S + task % S;
+                if (state[i] == kPending) return false;
+                scores[i] = score_run(stats[i]);
+                if (state[i] == kStored){ ++hits; continue; }
+                ++ran;
+                if (opt_.store && sl.whole){
+                    MAParams p = base_;
+                    p.fast = cells[c].first;
+                    p.slow = cells[c].second;
+                    opt_.store->put(hashes_[sl.d], p, stats[i]);
+                }
+            }
+            evaluations_.fetch_add(ran, std::memory_order_relaxed);
+            bars_.fetch_add(ran * sl.len, std::memory_order_relaxed);
+            if (hits) store_hits_.fetch_add(hits, std::memory_order_relaxed);
+            return true;
+        };
+        // Averages a tile whose slices are all posted (adding slices in order,
+        // as the serial loop did) and folds it into its thread's best.
+        auto complete = [&](size_t tile){
+            const size_t c0 = tile * T, k = std::min(T, C - c0);
+            Best tb;
+            auto local = tops_.local();
+            TopK& top = *local;
+            for (size_t c = c0; c < c0 + k; ++c){
+                double total = 0.0;
+                for (size_t j = 0; j < S; ++j) total += scores[c*S + j];
+                avg[c] = total / static_cast<double>(S);
+                if (!full) continue;
+                tb.offer(avg[c], cells[c]);
+                top.offer(avg[c], cells[c]);
+                const int f = cells[c].first - surface_.fast_min, sl = cells[c].second - surface_.slow_min;
+                surface_.score[size_t(f) * size_t(surface_.cols()) + size_t(sl)] = static_cast<float>(avg[c]);
+            }
+            if (!opt_.progress) return;
+            if (!procs) opt_.progress->done.fetch_add(k, std::memory_order_relaxed);
+            if (tb.set){
+                std::lock_guard<std::mutex> lk(live_mu_);
+                if (live_.offer(tb.score, tb.cell)){
+                    OptResult r;
+                    r.best_fast  = tb.cell.first;
+                    r.best_slow  = tb.cell.second;
+                    r.best_score = tb.score;
+                    opt_.progress->best.post(r);
+                }
+            }
+            if (opt_.progress->notify) opt_.progress->notify();
+        };
+
+        if (!procs){
+            // The task that posts a tile's last slice completes the tile.
+            std::unique_ptr<std::atomic<size_t>[]> pending(new std::atomic<size_t>[tiles]);
+            for (size_t t = 0; t < tiles; ++t) pending[t] = S;
+            for_each_task(tasks, [&](size_t task){
+                if (cancelled()) return;
+                lookup(task);
+                run(task);
+                post(task);
+                if (pending[task / S].fetch_sub(1, std::memory_order_acq_rel) == 1) complete(task / S);
+            });
+            return avg;
+        }
+
+        // Worker processes run the backtests; this process does the store
+        // lookups before and the scoring after. The SmaCache locks and
+        // allocates, so every column a pending backtest reads is computed
+        // here first and the workers only follow plain pointers; their
+        // kernel scratch is reserved here too. Tasks a crashed or timed-out
+        // worker lost are re-run here.
+        for_each_task(tasks, lookup);
+        std::vector<std::vector<const double*>> cols(S);   // [slice][window]
+        struct Column { size_t slice; int w; std::vector<double> own; };
+        std::vector<Column> needed;
+        for (size_t j = 0; j < S; ++j){
+            std::set<int> ws;
+            for (size_t c = 0; c < C; ++c)
+                if (state[c*S + j] == kPending){ ws.insert(cells[c].first); ws.insert(cells[c].second); }
+            ws.erase(ws.begin(), ws.upper_bound(0));   // invalid windows: the kernel skips those lanes
+            if (ws.empty()) continue;
+            cols[j].assign(static_cast<size_t>(*ws.rbegin()) + 1, nullptr);
+            for (int w : ws) needed.push_back({j, w, {}});
+        }
+        for_each_task(needed.size(), [&](size_t i){
+            Column& col = needed[i];
+            const double* p = caches_[slices[col.slice].d].sma->get(col.w, col.own);
+            if (p != col.own.data()) col.own = {};   // cached: the pointer outlives the search
+            cols[col.slice][static_cast<size_t>(col.w)] = p;
+        });
+        auto run_cols = [&](size_t task, std::vector<size_t>& idx){
+            run_with(task, [&](size_t j, int w, std::vector<double>&) -> const double* {
+                return w > 0 ? cols[j][static_cast<size_t>(w)] : nullptr;
+            }, idx);
+        };
+        // Each worker gets its own copy of this buffer with the fork; at
+        // kBacktestBlock entries the kernel never has to grow it.
+        std::vector<size_t> worker_idx;
+        worker_idx.reserve(kBacktestBlock);
+
+        const size_t done0 = opt_.progress ? opt_.progress->done.load() : 0;
+        const ProcessRun pr = run_in_processes(tasks, opt_.processes,
+            [&](size_t task){ run_cols(task, worker_idx); }, opt_.cancel,
+            [&](size_t finished){
+                if (!opt_.progress) return;
+                opt_.progress->done = done0 + finished * C / std::max<size_t>(1, tasks);
+                if (opt_.progress->notify) opt_.progress->notify();
+            }, opt_.process_task_timeout_ms);
+        crashed_workers_ += pr.crashed + pr.timed_out;
+        if (!cancelled())
+            for_each_task(pr.unfinished.size(), [&](size_t i){
+                std::vector<size_t> idx;
+                run_cols(pr.unfinished[i], idx);
+            });
+        for_each_task(tiles, [&](size_t tile){
+            bool ok = true;
+            for (size_t j = 0; j < S; ++j) ok = post(tile * S + j) && ok;
+            if (ok) complete(tile);
+        });
+        if (opt_.progress) opt_.progress->done = done0 + C;
+        return avg;
+    }
+
+    // Fills out's winner, top-K, surface and counters from everything scored
+    // at full budget, and flushes new results to opt.store. The top-K
+    // breakdowns come from the store or are re-run per dataset window from
+    // the memoized SMAs (top_k x datasets backtests, not counted in evaluations).
+    void finish(OptResult& out){
+        TopK top;
+        top.k = tops_.all().front().k;
+        for (const TopK& t : tops_.all()) top.merge(t);
+        for (const auto& [sc, cell] : top.items){
+            OptCandidate cand;
+            cand.fast  = cell.first;
+            cand.slow  = cell.second;
+            cand.score = sc;
+            MAParams p = base_;
+            p.fast = cell.first;
+            p.slow = cell.second;
+            for (size_t d = 0; d < caches_.size(); ++d){
+                const Window& w = caches_[d];
+                const bool whole = w.end - w.begin == w.sma->series().size();
+                BacktestStats st;
+                std::vector<double> sf, ss;
+                if (!whole || !opt_.store || !opt_.store->find(hashes_[d], p, st)){
+                    BacktestLane lane;
+                    lane.p       = p;
+                    lane.fast_ma = w.sma->get(p.fast, sf) + w.begin;
+                    lane.slow_ma = w.sma->get(p.slow, ss) + w.begin;
+                    run_ma_crossover_stats_batch(w.sma->series().close.data() + w.begin, w.end - w.begin, &lane, 1, &st);
+                }
+                cand.datasets.push_back({score_run(st), st.pnl, st.max_dd, st.trades});
+                cand.pnl    += st.pnl;
+                cand.max_dd += st.max_dd;
+                cand.trades += static_cast<double>(st.trades);
             }
+            const double n = static_cast<double>(caches_.size());
+            cand.pnl /= n; cand.max_dd /= n; cand.trades /= n;
+            out.top.push_back(std::move(cand));
+        }
+        if (!out.top.empty()){
+            out.best_score = out.top.front().score;
+            out.best_fast  = out.top.front().fast;
+            out.best_slow  = out.top.front().slow;
+        }
+        out.surface        = std::move(surface_);
+        out.evaluations    = evaluations_.load();
+        out.bars_evaluated = bars_.load();
+        out.store_hits     = store_hits_.load();
+        out.crashed_workers = crashed_workers_;
+        if (opt_.store) opt_.store->flush();
+        out.cancelled      = cancelled();
+    }
+
+private:
+    template <class Fn>
+    void for_each_task(size_t n, Fn&& fn){
+        if (pool_) pool_->parallel_for(n, fn);
+        else for (size_t i = 0; i < n; ++i) fn(i);
+    }
+
+    // A dataset's memo and the bars [begin, end) searched in it.
+    struct Window {
+        std::shared_ptr<SmaCache> sma;
+        size_t begin, end;
+    };
+
+    MAParams          base_;
+    const OptOptions& opt_;
+    std::vector<Window> caches_;
+    size_t            total_bars_ = 0;
+    std::unique_ptr<ThreadPool> own_;
+    ThreadPool*       pool_ = nullptr;
+    PerThread<TopK>   tops_;
+    ScoreSurface      surface_;
+    std::vector<uint64_t> hashes_;            // series_hash per dataset, with opt.store
+    std::atomic<size_t> evaluations_{0}, bars_{0}, store_hits_{0};
+    unsigned          crashed_workers_ = 0;
+    std::mutex        live_mu_;
+    Best              live_;                  // best so far, for opt.progress
+};
+
+// Indices of the n best scores: higher first, ties to the earlier cell, NaN last.
+static std::vector<size_t> top_n(const std::vector<Cell>& cells, const std::vector<double>& sc, size_t n){
+    std::vector<size_t> idx(cells.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    auto key = [&](size_t i){ return std::isnan(sc[i]) ? -HUGE_VAL : sc[i]; };
+    n = std::min(n, idx.size());
+    std::partial_sort(idx.begin(), idx.begin() + n, idx.end(), [&](size_t a, size_t b){
+        if (key(a) != key(b)) return key(a) > key(b);
+        return cells[a] < cells[b];
+    });
+    idx.resize(n);
+    return idx;
+}
+
+static std::vector<Cell> all_cells(const GridRange& g){
+    // The triangular grid flattened in serial (f, s) order. Cutting a list
+    // into equal tiles balances the work however short the rows near
+    // fast_max get.
+    std::vector<Cell> cells;
+    for (int f = g.fast_min; f <= g.fast_max; ++f)
+        for (int s = std::max(g.slow_min, f+1); s <= g.slow_max; ++s) cells.emplace_back(f, s);
+    return cells;
+}
+
+// Every cell, full data.
+static void search_grid(Scorer& sc, const GridRange& g){
+    sc.score(all_cells(g));
+}
+
+// Cells on a coarse lattice, then rounds that score the 3x3 neighbourhood of
+// the top-K cells at half the previous spacing, down to 1; at spacing 1 the
+// rounds repeat (a local hill climb) until they add nothing new.
+static void search_coarse_to_fine(Scorer& sc, const GridRange& g, const OptOptions& opt){
+    int step = opt.coarse_step > 0 ? opt.coarse_step
+             : std::max(1, std::max(g.fast_max - g.fast_min, g.slow_max - g.slow_min) / 16);
+    std::map<Cell, double> seen;
+    auto run = [&](std::vector<Cell> cells){
+        const std::vector<double> s = sc.score(cells);
+        for (size_t i = 0; i < cells.size(); ++i) seen[cells[i]] = s[i];
+    };
+
+    std::vector<Cell> coarse;
+    for (int f = g.fast_min; f <= g.fast_max; f += step)
+        for (int s = std::max(g.slow_min, f+1); s <= g.slow_max; s += step) coarse.emplace_back(f, s);
+    run(coarse);
+
+    for (int round = 0; round < 64 && !sc.cancelled(); ++round){
+        step = std::max(1, step / 2);
+        std::vector<Cell> known;
+        std::vector<double> score;
+        for (auto& [c, v] : seen){ known.push_back(c); score.push_back(v); }
+
+        std::vector<Cell> next;
+        for (size_t i : top_n(known, score, std::max<size_t>(1, opt.refine_k))){
+            for (int df = -step; df <= step; df += step)
+                for (int ds = -step; ds <= step; ds += step){
+                    const Cell c{known[i].first + df, known[i].second + ds};
+                    if (g.contains(c) && !seen.count(c)) next.push_back(c);
+                }
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        if (next.empty()){
+            if (step == 1) break;
+            continue;
         }
+        run(std::move(next));
+    }
+}
+
+// Scores every cell on a small recent slice of the data, keeps the better
+// half, doubles the slice and repeats; the last round uses all the data, so
+// the survivors' scores are exact. Rounds stop shrinking the first slice
+// below 2 * slow_max bars (fewer can't show a slow-MA crossover).
+static void search_halving(Scorer& sc, const GridRange& g){
+    std::vector<Cell> cells = all_cells(g);
+    const size_t total = sc.total_bars();
+    const size_t min_bars = std::max<size_t>(64, 2 * static_cast<size_t>(std::max(g.slow_max, 1)));
+    int rounds = 0;
+    while ((total >> (rounds + 1)) >= min_bars && (cells.size() >> (rounds + 1)) >= 8) ++rounds;
+
+    for (int r = 0; r <= rounds && !sc.cancelled(); ++r){
+        if (r == rounds){ sc.score(cells); break; }
+        const std::vector<double> s = sc.score(cells, total >> (rounds - r));
+        std::vector<Cell> keep;
+        for (size_t i : top_n(cells, s, (cells.size() + 1) / 2)) keep.push_back(cells[i]);
+        std::sort(keep.begin(), keep.end());
+        cells = std::move(keep);
+    }
+}
+
+// A seeded uniform sample of distinct cells (Floyd's algorithm), full data.
+static void search_random(Scorer& sc, const GridRange& g, const OptOptions& opt){
+    const std::vector<Cell> cells = all_cells(g);
+    const size_t n = cells.size();
+    const size_t m = std::min(n, opt.samples ? opt.samples : std::max<size_t>(64, n / 32));
+    std::mt19937_64 rng(opt.seed);
+    std::set<size_t> pick;
+    for (size_t j = n - m; j < n; ++j){
+        const size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+        if (!pick.insert(t).second) pick.insert(j);
+    }
+    std::vector<Cell> sample;
+    for (size_t i : pick) sample.push_back(cells[i]);
+    sc.score(sample);
+}
+
+} // namespace
+
+const char* search_strategy_name(SearchStrategy s){
+    switch (s){
+    case SearchStrategy::CoarseToFine:      return "coarse-to-fine";
+    case SearchStrategy::SuccessiveHalving: return "successive halving";
+    case SearchStrategy::Random:            return "random";
+    default:                                return "grid";
+    }
+}
+
+OptResult grid_search_fast_slow(const std::vector<SeriesPtr>& datasets,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt)
+{
+    std::vector<std::shared_ptr<SmaCache>> smas;
+    smas.reserve(datasets.size());
+    for (auto& ds : datasets)
+        if (ds && !ds->empty()) smas.push_back(std::make_shared<SmaCache>(ds));
+    return grid_search_fast_slow(smas, base, fast_min, fast_max, slow_min, slow_max, opt);
+}
+
+OptResult grid_search_fast_slow(const std::vector<std::shared_ptr<SmaCache>>& smas,
+                                const MAParams& base,
+                                int fast_min, int fast_max,
+                                int slow_min, int slow_max,
+                                const OptOptions& opt)
+{
+    // Candidates are scored from summary stats only; callers re-run the
+    // winner with run_ma_crossover when they need its curve.
+    OptResult out;
+    const GridRange g{fast_min, fast_max, slow_min, slow_max};
+    Scorer sc(smas, base, g, opt);
+    if (sc.empty()) return out;
+
+    switch (opt.strategy){
+    case SearchStrategy::CoarseToFine:      search_coarse_to_fine(sc, g, opt); break;
+    case SearchStrategy::SuccessiveHalving: search_halving(sc, g); break;
+    case SearchStrategy::Random:            search_random(sc, g, opt); break;
+    default:                                search_grid(sc, g); break;
     }
+    sc.finish(out);
     return out;
 }
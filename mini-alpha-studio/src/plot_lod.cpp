@@ -0,0 +1,237 @@
+#include "plot_lod.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// LTTB over the m points (x = at(i), y[at(i)]), appended to out.
+template <class At>
+void lttb(const std::vector<float>& y, size_t m, At&& at, size_t threshold, std::vector<uint32_t>& out){
+    if (threshold >= m || threshold < 3){
+        out.reserve(m);
+        for (size_t i = 0; i < m; ++i) out.push_back(at(i));
+        return;
+    }
+    out.reserve(out.size() + threshold);
+    out.push_back(at(0));
+
+    // The first and last points stay; the rest fall in threshold - 2 equal
+    // buckets. Each bucket keeps the point making the largest triangle with
+    // the point kept before it and the average of the next bucket.
+    const double every = static_cast<double>(m - 2) / static_cast<double>(threshold - 2);
+    size_t a = 0;
+    for (size_t b = 0; b + 2 < threshold; ++b){
+        const size_t lo = static_cast<size_t>(std::floor(double(b) * every)) + 1;
+        const size_t hi = std::min(m - 1, static_cast<size_t>(std::floor(double(b + 1) * every)) + 1);
+        const size_t nlo = hi;
+        const size_t nhi = std::min(m, static_cast<size_t>(std::floor(double(b + 2) * every)) + 1);
+
+        double ax = 0.0, ay = 0.0;
+        for (size_t j = nlo; j < nhi; ++j){ ax += at(j); ay += y[at(j)]; }
+        const double cnt = static_cast<double>(std::max<size_t>(1, nhi - nlo));
+        ax /= cnt; ay /= cnt;
+
+        const double px = at(a), py = y[at(a)];
+        double best = -1.0;
+        size_t pick = lo;
+        for (size_t j = lo; j < hi; ++j){
+            const double area = std::fabs((px - ax) * (double(y[at(j)]) - py) - (px - double(at(j))) * (ay - py));
+            if (area > best){ best = area; pick = j; }
+        }
+        out.push_back(at(pick));
+        a = pick;
+    }
+    out.push_back(at(m - 1));
+}
+
+} // namespace
+
+std::vector<uint32_t> lttb_select(const std::vector<float>& y, const std::vector<uint32_t>& index,
+                                  size_t threshold){
+    std::vector<uint32_t> out;
+    if (index.empty()) lttb(y, y.size(), [](size_t i){ return static_cast<uint32_t>(i); }, threshold, out);
+    else               lttb(y, index.size(), [&](size_t i){ return index[i]; }, threshold, out);
+    return out;
+}
+
+void SeriesLod::clear(){
+    y_.clear();
+    levels_.clear();
+    traces_.clear();
+    all_.clear();
+}
+
+void SeriesLod::build(std::vector<float> y){
+    clear();
+    y_ = std::move(y);
+    const size_t n = y_.size();
+    if (n == 0) return;
+
+    // Min/max pyramid: blocks of 8 points, then pairs of blocks up to one.
+    std::vector<std::pair<float, float>> lvl((n + 7) >> kLeafShift);
+    for (size_t b = 0; b < lvl.size(); ++b){
+        const size_t i0 = b << kLeafShift, i1 = std::min(n, i0 + 8);
+        float lo = y_[i0], hi = y_[i0];
+        for (size_t i = i0 + 1; i < i1; ++i){ lo = std::min(lo, y_[i]); hi = std::max(hi, y_[i]); }
+        lvl[b] = {lo, hi};
+    }
+    levels_.push_back(std::move(lvl));
+    while (levels_.back().size() > 1){
+        const auto& below = levels_.back();
+        std::vector<std::pair<float, float>> up((below.size() + 1) / 2);
+        for (size_t b = 0; b < up.size(); ++b){
+            up[b] = below[2 * b];
+            if (2 * b + 1 < below.size()){
+                up[b].first  = std::min(up[b].first,  below[2 * b + 1].first);
+                up[b].second = std::max(up[b].second, below[2 * b + 1].second);
+            }
+        }
+        levels_.push_back(std::move(up));
+    }
+
+    // LTTB traces, each decimated from the one above (reserved up front:
+    // each one is read while the next is appended).
+    traces_.reserve(64);
+    size_t t = kMaxTrace;
+    while (t >= n && t >= kMinTrace) t /= 2;
+    if (n <= kMaxTrace)
+        for (size_t i = 0; i < n; ++i) all_.push_back(static_cast<uint32_t>(i));
+    for (const std::vector<uint32_t>* from = &all_; t >= kMinTrace; t /= 2){
+        traces_.push_back(lttb_select(y_, *from, t));
+        from = &traces_.back();
+    }
+}
+
+std::pair<float, float> SeriesLod::minmax(size_t begin, size_t end) const {
+    float lo = INFINITY, hi = -INFINITY;
+    auto add = [&](float v){ lo = std::min(lo, v); hi = std::max(hi, v); };
+    constexpr size_t B = size_t(1) << kLeafShift;
+
+    // Loose points up to the first and back from the last whole block.
+    size_t a = begin, z = end;
+    while (a < z && a % B) add(y_[a++]);
+    while (z > a && z % B) add(y_[--z]);
+
+    // Whole blocks, bottom-up: an odd edge block is taken at this level,
+    // the rest pair up into the level above.
+    size_t i = a >> kLeafShift, j = z >> kLeafShift;
+    for (size_t k = 0; i < j; ++k, i >>= 1, j >>= 1){
+        const auto& lvl = levels_[k];
+        if (i & 1){ add(lvl[i].first); add(lvl[i].second); ++i; }
+        if (j & 1){ --j; add(lvl[j].first); add(lvl[j].second); }
+    }
+    return {lo, hi};
+}
+
+const std::vector<uint32_t>& SeriesLod::trace(size_t points) const {
+    for (auto it = traces_.rbegin(); it != traces_.rend(); ++it)
+        if (it->size() >= points) return *it;
+    return all_.empty() && !traces_.empty() ? traces_.front() : all_;
+}
+
+void SeriesLod::trace(size_t begin, size_t end, size_t points, std::vector<uint32_t>& out) const {
+    out.clear();
+    const size_t n = y_.size();
+    end = std::min(end, n);
+    if (begin >= end) return;
+    const size_t lo = begin > 0 ? begin - 1 : 0, hi = std::min(n, end + 1);
+    points = std::max<size_t>(points, 3);
+
+    if (end - begin <= 2 * points){
+        for (size_t i = lo; i < hi; ++i) out.push_back(static_cast<uint32_t>(i));
+        return;
+    }
+    // A stored trace with about `points` points inside the range has
+    // points * n / (end - begin) points in all.
+    const size_t want = points * n / (end - begin);
+    for (auto it = traces_.rbegin(); it != traces_.rend(); ++it){
+        if (it->size() < want) continue;
+        auto a = std::lower_bound(it->begin(), it->end(), static_cast<uint32_t>(begin));
+        auto b = std::lower_bound(a, it->end(), static_cast<uint32_t>(end));
+        if (a != it->begin()) --a;
+        if (b != it->end()) ++b;
+        out.assign(a, b);
+        return;
+    }
+    lttb(y_, hi - lo, [&](size_t i){ return static_cast<uint32_t>(lo + i); }, points, out);
+}
+
+size_t curve_index_at(const std::vector<BacktestPoint>& curve, int64_t ts_ms){
+    return static_cast<size_t>(std::lower_bound(curve.begin(), curve.end(), ts_ms,
+        [](const BacktestPoint& p, int64_t t){ return p.ts_ms < t; }) - curve.begin());
+}
+
+size_t series_index_at(const BarSeries& bars, int64_t ts_ms){
+    return static_cast<size_t>(std::lower_bound(bars.ts_ms.begin(), bars.ts_ms.end(), ts_ms) - bars.ts_ms.begin());
+}
+
+std::pair<size_t, size_t> trades_between(const std::vector<Trade>& trades, size_t bar_begin, size_t bar_end){
+    auto by_idx = [](const Trade& t, size_t i){ return t.idx < i; };
+    const auto a = std::lower_bound(trades.begin(), trades.end(), bar_begin, by_idx);
+    const auto b = std::lower_bound(a, trades.end(), bar_end, by_idx);
+    return {static_cast<size_t>(a - trades.begin()), static_cast<size_t>(b - trades.begin())};
+}
+
+void cluster_trades(const BarSeries& bars, const std::vector<BacktestPoint>& curve,
+                    const std::vector<Trade>& trades, double view_begin, double view_end, size_t cols,
+                    std::vector<TradeCluster>& out){
+    out.clear();
+    if (curve.empty() || cols == 0 || view_end <= view_begin) return;
+    const size_t a = std::min(curve.size() - 1, static_cast<size_t>(std::max(0.0, view_begin)));
+    const size_t b = std::clamp(static_cast<size_t>(std::ceil(view_end)), a + 1, curve.size());
+    const auto vis = trades_between(trades, series_index_at(bars, curve[a].ts_ms),
+                                    series_index_at(bars, curve[b - 1].ts_ms) + 1);
+
+    // A backtest curve is one point per bar from the first bar with both
+    // MAs to the last, so trade idx map to curve indices by an offset; when
+    // the timestamps say otherwise, each lookup gallops on from the last
+    // one, costing O(log gap) rather than O(log n).
+    const size_t first_bar = series_index_at(bars, curve.front().ts_ms);
+    const bool contiguous = first_bar + curve.size() <= bars.size() &&
+                            bars.ts_ms[first_bar + curve.size() - 1] == curve.back().ts_ms;
+
+    // Trades ascend by bar, so their columns do too: a cluster is a run of
+    // one column, kept per side.
+    const double per_px = static_cast<double>(cols) / (view_end - view_begin);
+    size_t at = a;
+    size_t open[2] = {SIZE_MAX, SIZE_MAX};   // out index of the current column's sell / buy cluster
+    uint32_t col_open = UINT32_MAX;
+    for (size_t t = vis.first; t < vis.second; ++t){
+        const Trade& tr = trades[t];
+        if (contiguous && tr.idx >= first_bar){
+            at = tr.idx - first_bar;
+        } else {
+            size_t step = 1;
+            while (at + step < curve.size() && curve[at + step].ts_ms < tr.ts_ms) step *= 2;
+            at = static_cast<size_t>(std::lower_bound(curve.begin() + at + step / 2,
+                                                      curve.begin() + std::min(curve.size(), at + step + 1), tr.ts_ms,
+                [](const BacktestPoint& p, int64_t ts){ return p.ts_ms < ts; }) - curve.begin());
+        }
+        const double x = (static_cast<double>(at) - view_begin) * per_px;
+        if (x < 0.0 || x >= static_cast<double>(cols)) continue;
+        const uint32_t col = static_cast<uint32_t>(x);
+        if (col != col_open){ col_open = col; open[0] = open[1] = SIZE_MAX; }
+
+        size_t& k = open[tr.dir > 0];
+        if (k == SIZE_MAX){
+            k = out.size();
+            out.push_back({col, tr.dir > 0 ? 1 : -1, 1, tr.px});
+        } else {
+            TradeCluster& c = out[k];
+            ++c.count;
+            c.px += (tr.px - c.px) / c.count;
+        }
+    }
+}
+
+const std::vector<TradeCluster>& TradeClusters::update(size_t version, const BarSeries& bars,
+                                                       const std::vector<BacktestPoint>& curve,
+                                                       const std::vector<Trade>& trades,
+                                                       double view_begin, double view_end, size_t cols){
+    if (version != version_ || view_begin != begin_ || view_end != end_ || cols != cols_){
+        cluster_trades(bars, curve, trades, view_begin, view_end, cols, clusters_);
+        version_ = version; begin_ = view_begin; end_ = view_end; cols_ = cols;
+        ++builds_;
+    }
+    return clusters_;
+}
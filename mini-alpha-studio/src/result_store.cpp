@@ -0,0 +1,217 @@
+#include "result_store.hpp"
+#include "mapped_file.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#if defined(_WIN32)
+  #include <fstream>
+#else
+  #include <fcntl.h>
+  #include <sys/file.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static const char kMagic[8] = {'M','A','R','E','S','U','L','T'};
+
+static inline uint64_t mix(uint64_t h, uint64_t v){
+  h = (h ^ v) * 0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> 29);
+}
+
+uint64_t series_hash(const BarSeries& bars){
+  uint64_t h = mix(0x6D696E69616C7068ULL, bars.size());
+  auto col = [&](const auto& c){
+    for (const auto& x : c){ uint64_t v; std::memcpy(&v, &x, 8); h = mix(h, v); }
+  };
+  col(bars.ts_ms); col(bars.open); col(bars.high); col(bars.low); col(bars.close); col(bars.volume);
+  return h;
+}
+
+static uint64_t record_check(const ResultRecord& r){
+  uint64_t w[9];
+  static_assert(sizeof(w) == offsetof(ResultRecord, check));
+  std::memcpy(w, &r, sizeof(w));
+  uint64_t h = 0xA5A5A5A5A5A5A5A5ULL;   // never 0 for an all-zero record
+  for (uint64_t v : w) h = mix(h, v);
+  return h | 1;
+}
+
+static inline uint32_t float_bits(float f){ return std::bit_cast<uint32_t>(f); }
+
+size_t ResultStore::KeyHash::operator()(const Key& k) const {
+  uint64_t h = mix(k.data_hash, static_cast<uint32_t>(k.fast) | uint64_t(static_cast<uint32_t>(k.slow)) << 32);
+  return static_cast<size_t>(mix(h, k.fee_bits | uint64_t(k.slip_bits) << 32));
+}
+
+ResultStore::Key ResultStore::key_of(uint64_t data_hash, const MAParams& p){
+  return {data_hash, p.fast, p.slow, float_bits(p.fee_bps), float_bits(p.slippage_bps)};
+}
+
+#if !defined(_WIN32)
+namespace {
+// flock held for the lifetime of the object; released on close.
+struct FileLock {
+  int fd = -1;
+  FileLock(const std::string& path, int flags, int op){
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd >= 0 && ::flock(fd, op) != 0){ ::close(fd); fd = -1; }
+  }
+  ~FileLock(){ if (fd >= 0) ::close(fd); }
+};
+} // namespace
+
+static bool write_all(int fd, const void* p, size_t n){
+  const char* c = static_cast<const char*>(p);
+  while (n > 0){
+    const ssize_t w = ::write(fd, c, n);
+    if (w <= 0) return false;
+    c += w; n -= static_cast<size_t>(w);
+  }
+  return true;
+}
+#endif
+
+bool ResultStore::open(const std::string& path, std::string& err){
+  flush();
+  {
+    std::lock_guard<std::mutex> lk(io_mu_);
+    if constexpr (std::endian::native != std::endian::little){ err = "result store needs a little-endian host"; return false; }
+    std::error_code ec;
+    const fs::path dir = fs::path(path).parent_path();
+    if (!dir.empty()) fs::create_directories(dir, ec);
+
+    ResultStoreHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version     = kResultStoreVersion;
+    h.record_size = sizeof(ResultRecord);
+#if !defined(_WIN32)
+    FileLock lk_file(path, O_RDWR | O_CREAT, LOCK_EX);
+    if (lk_file.fd < 0){ err = "Cannot open " + path; return false; }
+    struct stat st{};
+    if (fstat(lk_file.fd, &st) != 0){ err = "Cannot stat " + path; return false; }
+    if (st.st_size == 0 && !write_all(lk_file.fd, &h, sizeof(h))){ err = "Cannot write " + path; return false; }
+#else
+    if (!fs::exists(path, ec) || fs::file_size(path, ec) == 0){
+      std::ofstream f(path, std::ios::binary | std::ios::trunc);
+      if (!f.write(reinterpret_cast<const char*>(&h), sizeof(h))){ err = "Cannot write " + path; return false; }
+    }
+#endif
+    MappedFile mf;
+    if (!mf.open(path, err)) return false;
+    ResultStoreHeader got;
+    if (mf.size() < sizeof(got)){ err = path + ": truncated header"; return false; }
+    std::memcpy(&got, mf.data(), sizeof(got));
+    if (std::memcmp(got.magic, kMagic, sizeof(kMagic)) != 0 || got.version != kResultStoreVersion ||
+        got.record_size != sizeof(ResultRecord)){
+      err = path + ": not a result store of this version";
+      return false;
+    }
+  }
+  {
+    std::unique_lock<std::shared_mutex> lk(index_mu_);
+    index_.clear();
+  }
+  path_    = path;
+  read_to_ = sizeof(ResultStoreHeader);
+  refresh();
+  return true;
+}
+
+void ResultStore::refresh(){
+  if (!is_open()) return;
+  std::lock_guard<std::mutex> lk(io_mu_);
+#if !defined(_WIN32)
+  FileLock shared(path_, O_RDONLY, LOCK_SH);   // no writer mid-append while we map
+  if (shared.fd < 0) return;
+#endif
+  MappedFile mf; std::string err;
+  if (!mf.open(path_, err) || mf.size() <= read_to_) return;
+
+  // Whole records only; a record failing its check is a torn write left by
+  // a crashed writer and is skipped (the next append realigned after it).
+  const size_t rs = sizeof(ResultRecord);
+  const size_t end = read_to_ + (mf.size() - read_to_) / rs * rs;
+  std::unique_lock<std::shared_mutex> ilk(index_mu_);
+  for (size_t off = read_to_; off < end; off += rs){
+    ResultRecord r;
+    std::memcpy(&r, mf.data() + off, rs);
+    if (r.check != record_check(r)) continue;
+    BacktestStats s;
+    s.pnl = r.pnl; s.max_dd = r.max_dd;
+    s.trades = static_cast<size_t>(r.trades); s.bars = static_cast<size_t>(r.bars);
+    s.ret_mean = r.ret_mean; s.ret_std = r.ret_std;
+    index_[Key{r.data_hash, r.fast, r.slow, float_bits(r.fee_bps), float_bits(r.slippage_bps)}] = s;
+  }
+  read_to_ = end;
+}
+
+bool ResultStore::find(uint64_t data_hash, const MAParams& p, BacktestStats& out) const {
+  std::shared_lock<std::shared_mutex> lk(index_mu_);
+  auto it = index_.find(key_of(data_hash, p));
+  if (it == index_.end()) return false;
+  out = it->second;
+  return true;
+}
+
+void ResultStore::put(uint64_t data_hash, const MAParams& p, const BacktestStats& s){
+  {
+    std::unique_lock<std::shared_mutex> lk(index_mu_);
+    if (!index_.emplace(key_of(data_hash, p), s).second) return;   // already known
+  }
+  ResultRecord r{};
+  r.data_hash = data_hash;
+  r.fast = p.fast; r.slow = p.slow;
+  r.fee_bps = p.fee_bps; r.slippage_bps = p.slippage_bps;
+  r.pnl = s.pnl; r.max_dd = s.max_dd;
+  r.trades = s.trades; r.bars = s.bars;
+  r.ret_mean = s.ret_mean; r.ret_std = s.ret_std;
+  r.check = record_check(r);
+  std::lock_guard<std::mutex> lk(pending_mu_);
+  pending_.push_back(r);
+}
+
+bool ResultStore::flush(){
+  std::vector<ResultRecord> batch;
+  {
+    std::lock_guard<std::mutex> lk(pending_mu_);
+    batch.swap(pending_);
+  }
+  if (batch.empty() || !is_open()) return true;
+
+  bool ok = false;
+  {
+    std::lock_guard<std::mutex> lk(io_mu_);
+    const size_t rs = sizeof(ResultRecord), bytes = batch.size() * rs;
+#if !defined(_WIN32)
+    FileLock ex(path_, O_WRONLY | O_APPEND, LOCK_EX);
+    struct stat st{};
+    if (ex.fd >= 0 && fstat(ex.fd, &st) == 0){
+      // Pad a torn tail with zeros (which fail the check) so this batch
+      // starts on a record boundary.
+      const size_t size = static_cast<size_t>(st.st_size);
+      const size_t torn = size < sizeof(ResultStoreHeader) ? 0 : (size - sizeof(ResultStoreHeader)) % rs;
+      const std::vector<char> zeros(torn ? rs - torn : 0, 0);
+      ok = size >= sizeof(ResultStoreHeader) && write_all(ex.fd, zeros.data(), zeros.size()) &&
+           write_all(ex.fd, batch.data(), bytes);
+    }
+#else
+    std::ofstream f(path_, std::ios::binary | std::ios::app);
+    ok = f && f.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(bytes));
+#endif
+  }
+  if (!ok){
+    std::lock_guard<std::mutex> lk(pending_mu_);
+    pending_.insert(pending_.begin(), batch.begin(), batch.end());
+  }
+  return ok;
+}
+
+size_t ResultStore::size() const {
+  std::shared_lock<std::shared_mutex> lk(index_mu_);
+  return index_.size();
+}
@@ -0,0 +1,229 @@
+#include "signal_kernels.hpp"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define MA_SIMD_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define MA_TARGET(isa)
+#  else
+#    define MA_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define MA_SIMD_NEON 1
+#  include <arm_neon.h>
+#endif
+
+// ---- Shared chunk logic ----
+
+static CrossoverScan scan_init(size_t end, int pos) {
+    CrossoverScan r;
+    r.first = r.last = end;
+    r.pos = pos;
+    return r;
+}
+
+// Folds the masks of up to 32 consecutive bars starting at bar i into r. Bit k
+// of each mask describes bar i + k: gt/lt are the ordered fast > slow and
+// fast < slow compares (both clear when either MA is NaN), def marks bars with
+// both MAs defined, fin bars with a finite close. Only chunks that contain a
+// position flip take the loop.
+static inline void fold_chunk(size_t i, uint32_t gt, uint32_t lt, uint32_t def, uint32_t fin,
+                              CrossoverScan& r, std::vector<size_t>& idx) {
+    if (def == 0) return;
+    if (r.valid == 0) r.first = i + std::countr_zero(def);
+    r.last   = i + std::bit_width(def);
+    r.valid += std::popcount(def);
+    if ((fin & def) != def) r.finite = false;
+
+    uint32_t look = r.pos ? lt : gt;
+    while (look) {
+        const int k = std::countr_zero(look);
+        idx.push_back(i + k);
+        r.pos ^= 1;
+        const uint32_t after = ~((uint32_t(2) << k) - 1);   // bars past i + k
+        gt &= after;
+        lt &= after;
+        look = r.pos ? lt : gt;
+    }
+}
+
+static void scan_tail(const double* close, const double* mf, const double* ms,
+                      size_t i, size_t end, CrossoverScan& r, std::vector<size_t>& idx) {
+    for (; i < end; ++i) {
+        const double a = mf[i], b = ms[i];
+        if (std::isnan(a) || std::isnan(b)) continue;
+        if (r.valid++ == 0) r.first = i;
+        r.last = i + 1;
+        if (!std::isfinite(close[i])) r.finite = false;
+        if (r.pos ? a < b : a > b) { idx.push_back(i); r.pos ^= 1; }
+    }
+}
+
+static CrossoverScan scan_scalar(const double* close, const double* mf, const double* ms,
+                                 size_t begin, size_t end, int pos, std::vector<size_t>& idx) {
+    CrossoverScan r = scan_init(end, pos);
+    scan_tail(close, mf, ms, begin, end, r, idx);
+    return r;
+}
+
+// ---- x86-64 ----
+
+#if defined(MA_SIMD_X86)
+MA_TARGET("avx2")
+static CrossoverScan scan_avx2(const double* close, const double* mf, const double* ms,
+                               size_t begin, size_t end, int pos, std::vector<size_t>& idx) {
+    CrossoverScan r = scan_init(end, pos);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        uint32_t gt = 0, lt = 0, def = 0, fin = 0;
+        for (int h = 0; h < 2; ++h) {
+            const __m256d a = _mm256_loadu_pd(mf + i + 4 * h);
+            const __m256d b = _mm256_loadu_pd(ms + i + 4 * h);
+            const __m256d c = _mm256_loadu_pd(close + i + 4 * h);
+            const __m256d z = _mm256_sub_pd(c, c);                    // NaN unless c is finite
+            gt  |= uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))) << (4 * h);
+            lt  |= uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ))) << (4 * h);
+            def |= uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_ORD_Q))) << (4 * h);
+            fin |= uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(z, z, _CMP_ORD_Q))) << (4 * h);
+        }
+        fold_chunk(i, gt, lt, def, fin, r, idx);
+    }
+    scan_tail(close, mf, ms, i, end, r, idx);
+    return r;
+}
+
+MA_TARGET("avx512f")
+static CrossoverScan scan_avx512(const double* close, const double* mf, const double* ms,
+                                 size_t begin, size_t end, int pos, std::vector<size_t>& idx) {
+    CrossoverScan r = scan_init(end, pos);
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        uint32_t gt = 0, lt = 0, def = 0, fin = 0;
+        for (int h = 0; h < 2; ++h) {
+            const __m512d a = _mm512_loadu_pd(mf + i + 8 * h);
+            const __m512d b = _mm512_loadu_pd(ms + i + 8 * h);
+            const __m512d c = _mm512_loadu_pd(close + i + 8 * h);
+            const __m512d z = _mm512_sub_pd(c, c);
+            gt  |= uint32_t(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)) << (8 * h);
+            lt  |= uint32_t(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)) << (8 * h);
+            def |= uint32_t(_mm512_cmp_pd_mask(a, b, _CMP_ORD_Q)) << (8 * h);
+            fin |= uint32_t(_mm512_cmp_pd_mask(z, z, _CMP_ORD_Q)) << (8 * h);
+        }
+        fold_chunk(i, gt, lt, def, fin, r, idx);
+    }
+    scan_tail(close, mf, ms, i, end, r, idx);
+    return r;
+}
+#endif
+
+// ---- AArch64 ----
+
+#if defined(MA_SIMD_NEON)
+static inline uint32_t lane_bits(uint64x2_t m) {
+    return uint32_t(vgetq_lane_u64(m, 0) & 1) | uint32_t(vgetq_lane_u64(m, 1) & 1) << 1;
+}
+
+static CrossoverScan scan_neon(const double* close, const double* mf, const double* ms,
+                               size_t begin, size_t end, int pos, std::vector<size_t>& idx) {
+    CrossoverScan r = scan_init(end, pos);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        uint32_t gt = 0, lt = 0, def = 0, fin = 0;
+        for (int h = 0; h < 4; ++h) {
+            const float64x2_t a = vld1q_f64(mf + i + 2 * h);
+            const float64x2_t b = vld1q_f64(ms + i + 2 * h);
+            const float64x2_t c = vld1q_f64(close + i + 2 * h);
+            const float64x2_t z = vsubq_f64(c, c);
+            gt  |= lane_bits(vcgtq_f64(a, b)) << (2 * h);
+            lt  |= lane_bits(vcltq_f64(a, b)) << (2 * h);
+            def |= lane_bits(vandq_u64(vceqq_f64(a, a), vceqq_f64(b, b))) << (2 * h);
+            fin |= lane_bits(vceqq_f64(z, z)) << (2 * h);
+        }
+        fold_chunk(i, gt, lt, def, fin, r, idx);
+    }
+    scan_tail(close, mf, ms, i, end, r, idx);
+    return r;
+}
+#endif
+
+// ---- Dispatch ----
+
+static SimdIsa detect_isa() {
+#if defined(MA_SIMD_X86)
+#  if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] >> 27) & 1, avx = (info[2] >> 28) & 1;
+    if (!osxsave || !avx || max_leaf < 7) return SimdIsa::Scalar;
+    const unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) return SimdIsa::Scalar;             // OS saves YMM state
+    __cpuidex(info, 7, 0);
+    if (((info[1] >> 16) & 1) && (xcr0 & 0xe6) == 0xe6) return SimdIsa::Avx512;
+    if ((info[1] >> 5) & 1) return SimdIsa::Avx2;
+    return SimdIsa::Scalar;
+#  else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdIsa::Avx512;
+    if (__builtin_cpu_supports("avx2"))    return SimdIsa::Avx2;
+    return SimdIsa::Scalar;
+#  endif
+#elif defined(MA_SIMD_NEON)
+    return SimdIsa::Neon;   // Advanced SIMD is mandatory on AArch64
+#else
+    return SimdIsa::Scalar;
+#endif
+}
+
+static std::atomic<int> g_isa{-1};
+
+SimdIsa simd_isa_supported() {
+    static const SimdIsa isa = detect_isa();
+    return isa;
+}
+
+SimdIsa simd_isa() {
+    const int v = g_isa.load(std::memory_order_relaxed);
+    return v < 0 ? simd_isa_supported() : static_cast<SimdIsa>(v);
+}
+
+void set_simd_isa(SimdIsa isa) {
+    // x86 levels nest (AVX-512 machines run the AVX2 path too); NEON only
+    // exists on ARM builds.
+    const SimdIsa best = simd_isa_supported();
+    if (isa == SimdIsa::Neon && best != SimdIsa::Neon) isa = SimdIsa::Scalar;
+    if ((isa == SimdIsa::Avx2 || isa == SimdIsa::Avx512) && (best == SimdIsa::Neon || best == SimdIsa::Scalar))
+        isa = SimdIsa::Scalar;
+    if (isa == SimdIsa::Avx512 && best != SimdIsa::Avx512) isa = SimdIsa::Avx2;
+    g_isa.store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::Neon:   return "neon";
+    case SimdIsa::Avx2:   return "avx2";
+    case SimdIsa::Avx512: return "avx512";
+    default:              return "scalar";
+    }
+}
+
+CrossoverScan crossover_scan(const double* close, const double* fast_ma, const double* slow_ma,
+                             size_t begin, size_t end, int pos, std::vector<size_t>& idx) {
+    if (begin >= end) return scan_init(end, pos);
+    switch (simd_isa()) {
+#if defined(MA_SIMD_X86)
+    case SimdIsa::Avx512: return scan_avx512(close, fast_ma, slow_ma, begin, end, pos, idx);
+    case SimdIsa::Avx2:   return scan_avx2(close, fast_ma, slow_ma, begin, end, pos, idx);
+#endif
+#if defined(MA_SIMD_NEON)
+    case SimdIsa::Neon:   return scan_neon(close, fast_ma, slow_ma, begin, end, pos, idx);
+#endif
+    default:              return scan_scalar(close, fast_ma, slow_ma, begin, end, pos, idx);
+    }
+}
@@ -4,25 +4,41 @@
 #include <thread>
 #include <cstdio>
 #include <string>
-#include "csv.hpp"
+#include "bar_stream.hpp"
 
-// Minimal stub for now; you can replace with the full version later.
+// Usage: streamer_pi [csv] [host] [port] [delay_ms]
+// Replays the CSV's closes as "ts_ms,close" datagrams. The file is read through
+// BarStream, so memory stays flat however long the history is. Without a CSV
+// it sends a few dummy ticks so the binary links & runs.
 int main(int argc, char** argv){
+  const char* csv  = (argc>1 ? argv[1] : "");
   const char* host = (argc>2 ? argv[2] : "239.1.1.1");
   int port = (argc>3 ? std::stoi(argv[3]) : 5005);
+  int delay_ms = (argc>4 ? std::stoi(argv[4]) : 50);
 
-  // Send a few dummy ticks so the binary links & runs.
   int sock = socket(AF_INET, SOCK_DGRAM, 0);
   sockaddr_in addr{}; addr.sin_family=AF_INET; addr.sin_port=htons(port);
   addr.sin_addr.s_addr=inet_addr(host);
 
-  for (int i=0;i<10;++i){
+  auto send_tick = [&](long long ts, double px){
     char buf[64];
-    int n = std::snprintf(buf, sizeof(buf), "%lld,%.4f\n",
-                          (long long)(1704067200000LL + i*60000LL), 100.0 + i*0.1);
+    int n = std::snprintf(buf, sizeof(buf), "%lld,%.4f\n", ts, px);
     sendto(sock, buf, n, 0, (sockaddr*)&addr, sizeof(addr));
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+  };
+
+  if (csv[0]){
+    BarStream in;
+    std::string err;
+    if (!in.open(csv, err)){ std::fprintf(stderr, "streamer_pi: %s\n", err.c_str()); return 1; }
+    Bar b;
+    while (in.next(b)) send_tick((long long)b.ts_ms, b.close);
+    if (!in.warn().empty()) std::fprintf(stderr, "streamer_pi: WARN %s\n", in.warn().c_str());
+    std::printf("streamer_pi: sent %zu bars from %s\n", in.count(), csv);
+    return 0;
   }
+
+  for (int i=0;i<10;++i) send_tick(1704067200000LL + i*60000LL, 100.0 + i*0.1);
   std::puts("streamer_pi: sent 10 dummy ticks");
   return 0;
 }
@@ -0,0 +1,152 @@
+#include "sweep.hpp"
+#include "indicator_cache.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+SweepSpec SweepSpec::around(const MAParams& base){
+    SweepSpec s;
+    s.fast         = SweepAxis<int>::single(base.fast);
+    s.slow         = SweepAxis<int>::single(base.slow);
+    s.fee_bps      = SweepAxis<float>::single(base.fee_bps);
+    s.slippage_bps = SweepAxis<float>::single(base.slippage_bps);
+    return s;
+}
+
+size_t SweepSpace::size() const {
+    return pairs() * costs();
+}
+
+MAParams SweepSpace::at(size_t i) const {
+    MAParams p;
+    const size_t np = spec_.slippage_bps.size(), nf = spec_.fee_bps.size(), ns = spec_.slow.size();
+    p.slippage_bps = spec_.slippage_bps.at(i % np); i /= np;
+    p.fee_bps      = spec_.fee_bps.at(i % nf);      i /= nf;
+    p.slow         = spec_.slow.at(i % ns);         i /= ns;
+    p.fast         = spec_.fast.at(i);
+    return p;
+}
+
+namespace {
+
+// The k best points, best first: higher score, then lower index.
+struct TopPoints {
+    size_t k = 1;
+    std::vector<SweepPoint> items;
+
+    static bool before(const SweepPoint& a, const SweepPoint& b){
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    }
+    void offer(const SweepPoint& v){
+        if (!(v.score > -1e300)) return;
+        if (items.size() == k && !before(v, items.back())) return;
+        items.insert(std::upper_bound(items.begin(), items.end(), v, before), v);
+        if (items.size() > k) items.pop_back();
+    }
+};
+
+// Per-thread buffers, reused across pairs.
+struct SweepScratch {
+    CrossoverSignal     sig;
+    std::vector<double> fast_ma, slow_ma;   // only used past the SMA memo's budget
+    std::vector<SweepPoint> acc;            // one per cost point of the pair
+    std::vector<MAParams>      params;      // acc[k].p, contiguous for the replay
+    std::vector<BacktestStats> stats;
+    TopPoints           top;
+    size_t              evaluated = 0, signal_passes = 0, pnl_passes = 0;
+};
+
+} // namespace
+
+SweepResult sweep_ma_crossover(const std::vector<SeriesPtr>& datasets, const SweepSpec& spec,
+                               const SweepOptions& opt)
+{
+    const SweepSpace space(spec);
+    SweepResult out;
+    out.points = space.size();
+
+    std::vector<std::unique_ptr<SmaCache>> caches;
+    for (auto& ds : datasets)
+        if (ds && !ds->empty()) caches.push_back(std::make_unique<SmaCache>(ds));
+    if (caches.empty() || out.points == 0) return out;
+
+    const size_t P = space.pairs(), K = space.costs(), NS = spec.slow.size();
+    auto valid = [&](size_t q){
+        const int f = spec.fast.at(q / NS), s = spec.slow.at(q % NS);
+        return f > 0 && s > 0 && f < s;
+    };
+    if (opt.progress){
+        size_t n = 0;
+        for (size_t q = 0; q < P; ++q) n += valid(q);
+        opt.progress->done  = 0;
+        opt.progress->total = n * K;
+    }
+
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool* pool = pool_for(opt.threads, own);
+
+    SweepScratch init;
+    init.top.k = std::max<size_t>(1, opt.top_k);
+    init.acc.resize(K); init.params.resize(K); init.stats.resize(K);
+    PerThread<SweepScratch> scratch(pool, init);
+
+    auto cancelled = [&]{ return opt.cancel && opt.cancel->load(std::memory_order_relaxed); };
+    const double D = static_cast<double>(caches.size());
+
+    // One task per (fast, slow) pair: the SMAs and the scan are done once per
+    // dataset, the cost points only replay the scanned signal.
+    auto run_pair = [&](size_t q){
+        if (cancelled() || !valid(q)) return;
+        auto local = scratch.local();
+        SweepScratch& sc = *local;
+        const size_t base_index = q * K;
+        for (size_t k = 0; k < K; ++k){
+            SweepPoint& pt = sc.acc[k];
+            pt = SweepPoint{};
+            pt.index = base_index + k;
+            pt.p     = space.at(pt.index);
+            pt.score = 0.0;
+            sc.params[k] = pt.p;
+        }
+        for (auto& cache : caches){
+            const BarSeries& bars = cache->series();
+            const double* close = bars.close.data();
+            const double* fm = cache->get(sc.acc[0].p.fast, sc.fast_ma);
+            const double* sm = cache->get(sc.acc[0].p.slow, sc.slow_ma);
+            scan_ma_crossover(close, fm, sm, bars.size(), sc.sig);
+            ++sc.signal_passes;
+            replay_ma_crossover(close, fm, sm, sc.sig, sc.params.data(), K, sc.stats.data());
+            for (size_t k = 0; k < K; ++k){
+                SweepPoint& pt = sc.acc[k];
+                const BacktestStats& st = sc.stats[k];
+                pt.score  += score_run(st);
+                pt.pnl    += st.pnl;
+                pt.max_dd += st.max_dd;
+                pt.trades += static_cast<double>(st.trades);
+            }
+            sc.pnl_passes += K;
+        }
+        for (SweepPoint& pt : sc.acc){
+            pt.score /= D; pt.pnl /= D; pt.max_dd /= D; pt.trades /= D;
+            sc.top.offer(pt);
+            if (opt.on_point) opt.on_point(pt);
+        }
+        sc.evaluated += K;
+        if (opt.progress) opt.progress->done.fetch_add(K, std::memory_order_relaxed);
+    };
+    if (pool) pool->parallel_for(P, run_pair);
+    else for (size_t q = 0; q < P; ++q) run_pair(q);
+
+    TopPoints top;
+    top.k = std::max<size_t>(1, opt.top_k);
+    for (SweepScratch& sc : scratch.all()){
+        for (const SweepPoint& pt : sc.top.items) top.offer(pt);
+        out.evaluated     += sc.evaluated;
+        out.signal_passes += sc.signal_passes;
+        out.pnl_passes    += sc.pnl_passes;
+    }
+    out.top       = std::move(top.items);
+    out.cancelled = cancelled();
+    return out;
+}
@@ -0,0 +1,97 @@
+#include "thread_pool.hpp"
+
+// Which pool (if any) the current thread works for, and its slot there.
+static thread_local const ThreadPool* tl_pool  = nullptr;
+static thread_local int               tl_index = -1;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) queues_.push_back(std::make_unique<WorkerQueue>());
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this, i]{ worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool* pool_for(unsigned threads, std::unique_ptr<ThreadPool>& own) {
+    if (threads == 0) return &ThreadPool::shared();
+    if (threads == 1) return nullptr;
+    own = std::make_unique<ThreadPool>(threads - 1);
+    return own.get();
+}
+
+int ThreadPool::worker_index() const {
+    return tl_pool == this ? tl_index : -1;
+}
+
+void ThreadPool::push(std::function<void()> job) {
+    const int self = worker_index();
+    if (self >= 0) {
+        std::lock_guard<std::mutex> lk(queues_[self]->mu);
+        queues_[self]->jobs.push_back(std::move(job));
+        queued_.fetch_add(1);
+    }
+    {
+        // Taking mu_ orders the count update before any sleeper's re-check.
+        std::lock_guard<std::mutex> lk(mu_);
+        if (self < 0) {
+            inject_.push_back(std::move(job));
+            queued_.fetch_add(1);
+        }
+    }
+    cv_.notify_one();
+}
+
+// Own deque from the back, then the other deques from the front starting
+// after our own slot, then the injection queue.
+bool ThreadPool::try_run_one(int self) {
+    if (queued_.load() == 0) return false;
+
+    std::function<void()> job;
+    if (self >= 0) {
+        WorkerQueue& q = *queues_[self];
+        std::lock_guard<std::mutex> lk(q.mu);
+        if (!q.jobs.empty()) { job = std::move(q.jobs.back()); q.jobs.pop_back(); }
+    }
+    const size_t n = queues_.size();
+    for (size_t k = 1; !job && k <= n; ++k) {
+        const size_t v = (static_cast<size_t>(self + 1) + k - 1) % n;
+        if (static_cast<int>(v) == self) continue;
+        WorkerQueue& q = *queues_[v];
+        std::lock_guard<std::mutex> lk(q.mu);
+        if (!q.jobs.empty()) { job = std::move(q.jobs.front()); q.jobs.pop_front(); }
+    }
+    if (!job) {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!inject_.empty()) { job = std::move(inject_.front()); inject_.pop_front(); }
+    }
+    if (!job) return false;
+
+    queued_.fetch_sub(1);
+    job();
+    return true;
+}
+
+void ThreadPool::worker_loop(unsigned self) {
+    tl_pool  = this;
+    tl_index = static_cast<int>(self);
+    for (;;) {
+        if (try_run_one(tl_index)) continue;
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_.wait(lk, [this]{ return stop_ || queued_.load() > 0; });
+        if (stop_ && queued_.load() == 0) return;   // stop_ and drained
+    }
+}
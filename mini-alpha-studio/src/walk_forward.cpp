@@ -0,0 +1,144 @@
+#include "walk_forward.hpp"
+#include "indicator_cache.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// One fold's work item and what it produced, before stitching.
+struct FoldTask {
+    size_t series = 0;   // index into the memos
+    WalkForwardFold fold;
+    std::vector<BacktestPoint> curve;
+    std::vector<Trade>         trades;
+    size_t evaluations = 0, bars_evaluated = 0;
+};
+
+// Stats of a stitched curve, computed the way CrossoverState marks bars.
+BacktestStats curve_stats(const std::vector<BacktestPoint>& curve, size_t trades){
+    BacktestStats st;
+    RunningMoments ret;
+    double peak = 0.0, prev = 0.0;
+    for (const BacktestPoint& pt : curve){
+        peak      = std::max(peak, pt.equity);
+        st.max_dd = std::max(st.max_dd, peak - pt.equity);
+        ret.add(pt.equity - prev);
+        prev = pt.equity;
+    }
+    st.pnl      = curve.empty() ? 0.0 : curve.back().equity;
+    st.trades   = trades;
+    st.bars     = curve.size();
+    st.ret_mean = ret.get_mean();
+    st.ret_std  = ret.get_std();
+    return st;
+}
+
+} // namespace
+
+WalkForwardResult walk_forward(const std::vector<SeriesPtr>& datasets,
+                               const MAParams& base,
+                               int fast_min, int fast_max,
+                               int slow_min, int slow_max,
+                               const WalkForwardSpec& spec,
+                               const OptOptions& opt)
+{
+    WalkForwardResult out;
+    if (spec.train_bars == 0 || spec.test_bars == 0) return out;
+
+    // Folds of every series, in order: test windows back to back from the
+    // end of the first training window.
+    std::vector<std::shared_ptr<SmaCache>> smas;
+    std::vector<FoldTask> tasks;
+    for (auto& ds : datasets){
+        if (!ds || ds->size() <= spec.train_bars) continue;
+        const size_t n = ds->size();
+        for (size_t tb = spec.train_bars; tb < n; tb += spec.test_bars){
+            FoldTask t;
+            t.series = smas.size();
+            t.fold.train_begin = spec.anchored ? 0 : tb - spec.train_bars;
+            t.fold.train_end   = tb;
+            t.fold.test_begin  = tb;
+            t.fold.test_end    = std::min(n, tb + spec.test_bars);
+            tasks.push_back(std::move(t));
+        }
+        smas.push_back(std::make_shared<SmaCache>(ds));
+    }
+    out.folds = tasks.size();
+    if (tasks.empty()) return out;
+    if (opt.progress){ opt.progress->done = 0; opt.progress->total = tasks.size(); }
+
+    // Folds are the parallel unit: each fold's search runs on its fold's
+    // thread rather than fanning out again on the pool running the folds.
+    std::unique_ptr<ThreadPool> own;
+    ThreadPool* pool = pool_for(opt.threads, own);
+
+    OptOptions fold_opt = opt;
+    fold_opt.threads   = 1;
+    fold_opt.processes = 0;
+    fold_opt.progress  = nullptr;
+    fold_opt.store     = nullptr;
+    fold_opt.top_k     = 1;
+
+    auto cancelled = [&]{ return opt.cancel && opt.cancel->load(std::memory_order_relaxed); };
+    // A fold that stops early (cancelled, or no pair scored) still counts as done.
+    auto fold = [&](FoldTask& t){
+        WalkForwardFold& f = t.fold;
+        if (cancelled()) return;
+        SmaCache& sma = *smas[t.series];
+
+        OptOptions o = fold_opt;
+        o.bar_begin = f.train_begin;
+        o.bar_end   = f.train_end;
+        const OptResult r = grid_search_fast_slow({smas[t.series]}, base, fast_min, fast_max, slow_min, slow_max, o);
+        t.evaluations    = r.evaluations;
+        t.bars_evaluated = r.bars_evaluated;
+        if (r.cancelled || !(r.best_score > -1e300)) return;
+        f.fast        = r.best_fast;
+        f.slow        = r.best_slow;
+        f.train_score = r.best_score;
+
+        MAParams p = base;
+        p.fast = f.fast;
+        p.slow = f.slow;
+        BacktestWorkspace ws;
+        const double* fm = sma.get(p.fast, ws.fast_ma);
+        const double* sm = sma.get(p.slow, ws.slow_ma);
+        const BacktestResult& res = run_ma_crossover(sma.series(), fm, sm, f.test_begin, f.test_end, p, ws);
+        t.curve  = res.curve;
+        t.trades = res.trades;
+        f.oos        = curve_stats(t.curve, t.trades.size());
+        f.oos_score  = score_run(f.oos);
+    };
+    auto run_fold = [&](size_t i){
+        fold(tasks[i]);
+        if (opt.progress) opt.progress->done.fetch_add(1, std::memory_order_relaxed);
+    };
+    if (pool) pool->parallel_for(tasks.size(), run_fold);
+    else for (size_t i = 0; i < tasks.size(); ++i) run_fold(i);
+
+    // Stitch each series' folds in order.
+    out.series.resize(smas.size());
+    for (FoldTask& t : tasks){
+        WalkForwardSeries& s = out.series[t.series];
+        const double offset = s.curve.empty() ? 0.0 : s.curve.back().equity;
+        for (BacktestPoint pt : t.curve){
+            pt.equity += offset;
+            s.curve.push_back(pt);
+        }
+        s.trades.insert(s.trades.end(), t.trades.begin(), t.trades.end());
+        s.folds.push_back(t.fold);
+        out.evaluations    += t.evaluations;
+        out.bars_evaluated += t.bars_evaluated;
+    }
+    for (WalkForwardSeries& s : out.series){
+        s.oos       = curve_stats(s.curve, s.trades.size());
+        s.oos_score = score_run(s.oos);
+        out.oos_score += s.oos_score;
+        out.oos_pnl   += s.oos.pnl;
+    }
+    out.oos_score /= static_cast<double>(out.series.size());
+    out.oos_pnl   /= static_cast<double>(out.series.size());
+    out.cancelled  = cancelled();
+    return out;
+}
@@ -0,0 +1,150 @@
+#include "worker_procs.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(_WIN32)
+
+bool worker_processes_supported(){ return false; }
+void* map_shared_bytes(size_t){ return nullptr; }
+void  unmap_shared_bytes(void*, size_t){}
+
+ProcessRun run_in_processes(size_t tasks, unsigned, const std::function<void(size_t)>&,
+                            const std::atomic<bool>*, const std::function<void(size_t)>&, unsigned){
+    ProcessRun r;
+    for (size_t t = 0; t < tasks; ++t) r.unfinished.push_back(t);
+    return r;
+}
+
+#else
+
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool worker_processes_supported(){ return true; }
+
+void* map_shared_bytes(size_t bytes){
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;   // anonymous mappings start zeroed
+}
+
+void unmap_shared_bytes(void* p, size_t bytes){
+    if (p) munmap(p, bytes);
+}
+
+namespace {
+
+// The shared control block: a ticket counter is the whole queue, since the
+// task list is fixed up front. Address-free lock-free atomics only.
+struct Control {
+    std::atomic<size_t>   next{0};
+    std::atomic<size_t>   finished{0};
+    std::atomic<uint32_t> stop{0};
+};
+static_assert(std::atomic<size_t>::is_always_lock_free, "shared counters must be lock-free");
+static_assert(std::atomic<int64_t>::is_always_lock_free, "shared clocks must be lock-free");
+
+// steady_clock is CLOCK_MONOTONIC here, so its readings compare across processes.
+int64_t now_ns(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// busy: when this worker started its current task, 0 while between tasks.
+[[noreturn]] void worker_main(Control& ctl, std::atomic<int64_t>& busy, unsigned char* done, size_t tasks,
+                              const std::function<void(size_t)>& fn){
+    try {
+        for (;;){
+            if (ctl.stop.load(std::memory_order_relaxed)) break;
+            const size_t t = ctl.next.fetch_add(1, std::memory_order_relaxed);
+            if (t >= tasks) break;
+            busy.store(now_ns(), std::memory_order_relaxed);
+            fn(t);
+            done[t] = 1;
+            busy.store(0, std::memory_order_relaxed);
+            ctl.finished.fetch_add(1, std::memory_order_release);
+        }
+    } catch (...) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+} // namespace
+
+ProcessRun run_in_processes(size_t tasks, unsigned workers, const std::function<void(size_t)>& fn,
+                            const std::atomic<bool>* cancel, const std::function<void(size_t)>& on_progress,
+                            unsigned task_timeout_ms){
+    ProcessRun r;
+    workers = static_cast<unsigned>(std::min<size_t>(workers, tasks));
+    const size_t busy_bytes = std::max<size_t>(1, workers) * sizeof(std::atomic<int64_t>);
+    void* ctl_mem  = map_shared_bytes(sizeof(Control));
+    void* busy_mem = map_shared_bytes(busy_bytes);
+    SharedArray<unsigned char> done(tasks, true);
+    if (!ctl_mem || !busy_mem){
+        unmap_shared_bytes(ctl_mem, sizeof(Control));
+        unmap_shared_bytes(busy_mem, busy_bytes);
+        for (size_t t = 0; t < tasks; ++t) r.unfinished.push_back(t);
+        return r;
+    }
+    Control* ctl = new (ctl_mem) Control();
+    std::atomic<int64_t>* busy = static_cast<std::atomic<int64_t>*>(busy_mem);
+    for (unsigned w = 0; w < workers; ++w) new (&busy[w]) std::atomic<int64_t>(0);
+
+    std::vector<pid_t> pids;
+    for (unsigned w = 0; w < workers; ++w){
+        const pid_t pid = fork();
+        if (pid == 0) worker_main(*ctl, busy[w], done.data(), tasks, fn);
+        if (pid < 0) break;   // out of processes: run with what started
+        pids.push_back(pid);
+    }
+    r.workers = static_cast<unsigned>(pids.size());
+
+    // The watchdog: a cancel kills every worker, the timeout one that has
+    // been on the same task too long. Killed workers' tasks stay unfinished.
+    const int64_t timeout_ns = int64_t(task_timeout_ms) * 1000000;
+    std::vector<char> killed(pids.size(), 0);
+    bool stopping = false;
+    size_t alive = pids.size();
+    while (alive > 0){
+        if (!stopping && cancel && cancel->load(std::memory_order_relaxed)){
+            stopping = true;
+            ctl->stop.store(1, std::memory_order_relaxed);
+            for (size_t w = 0; w < pids.size(); ++w)
+                if (pids[w] > 0 && !killed[w]){ kill(pids[w], SIGKILL); killed[w] = 1; }
+        }
+        if (timeout_ns > 0){
+            const int64_t now = now_ns();
+            for (size_t w = 0; w < pids.size(); ++w){
+                const int64_t since = busy[w].load(std::memory_order_relaxed);
+                if (pids[w] <= 0 || killed[w] || since == 0 || now - since <= timeout_ns) continue;
+                kill(pids[w], SIGKILL);
+                killed[w] = 1;
+                ++r.timed_out;
+            }
+        }
+        for (size_t w = 0; w < pids.size(); ++w){
+            if (pids[w] <= 0) continue;
+            int status = 0;
+            const pid_t got = waitpid(pids[w], &status, WNOHANG);
+            if (got == 0) continue;
+            if (!killed[w] && (got < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)) ++r.crashed;
+            pids[w] = -1;
+            --alive;
+        }
+        if (on_progress) on_progress(ctl->finished.load(std::memory_order_acquire));
+        if (alive > 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    for (size_t t = 0; t < tasks; ++t)
+        if (!done[t]) r.unfinished.push_back(t);
+    ctl->~Control();
+    unmap_shared_bytes(ctl_mem, sizeof(Control));
+    unmap_shared_bytes(busy_mem, busy_bytes);
+    return r;
+}
+
+#endif